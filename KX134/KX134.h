@@ -0,0 +1,91 @@
+#ifndef KX134_H
+#define KX134_H
+
+#include "KX134Base.h"
+
+/**
+ * @brief KX134 driver with its transport bound at compile time
+ *
+ * Wraps a transport such as KX134SPI or KX134I2C and shadows the sample path (dataReady(),
+ * getAccelerations(), getBufferSampleCount() and readBuffer()) with versions that call the
+ * transport's readRegister() directly instead of through the virtual function table. This lets
+ * the compiler inline the sample conversion into the bus read.
+ *
+ * Everything else, including configuration, is inherited unchanged, and a KX134<Transport> can
+ * still be used through a KX134Base reference, in which case the virtual path is taken.
+ *
+ * @code
+ * KX134<KX134SPI> accel(PIN_SPI_MOSI, PIN_SPI_MISO, PIN_SPI_SCK, PIN_SPI_CS);
+ * @endcode
+ *
+ * @tparam Transport The KX134Base subclass implementing readRegister() and writeRegister()
+ */
+template <typename Transport> class KX134 final : public Transport
+{
+public:
+    using Transport::Transport;
+    using typename KX134Base::Register;
+
+    /**
+     * @brief Reads the accelerations in LSB immediately
+     *
+     * @param[out] output The array to read accelerations into. output[0] is X acceleration,
+     * output[1] is Y accel, output[2] is Z accel.
+     */
+    void getAccelerations(int16_t* output)
+    {
+        char words[KX134Base::BUFFER_BYTES_PER_SAMPLE];
+        Transport::readRegister(Register::XOUT_L, words, KX134Base::BUFFER_BYTES_PER_SAMPLE);
+        this->unpackSamples(words, output, 1);
+    }
+
+    /**
+     * @brief Returns if the unit is ready to read acceleration data
+     *
+     * @return true if ready, false otherwise
+     */
+    bool dataReady()
+    {
+        char buf;
+        Transport::readRegister(Register::INS2, &buf, 1);
+        return buf & (1 << 4); // bit4 should be set
+    }
+
+    /**
+     * @brief Reads the number of complete XYZ samples currently held in the sample buffer
+     *
+     * @return The number of samples available to readBuffer()
+     */
+    size_t getBufferSampleCount()
+    {
+        char status[2];
+        Transport::readRegister(Register::BUF_STATUS_1, status, 2);
+
+        size_t bytes = static_cast<uint8_t>(status[0]) | ((status[1] & 0b11) << 8);
+        return bytes / this->getBufferBytesPerSample();
+    }
+
+    /**
+     * @brief Drains samples from the sample buffer in a single burst read
+     *
+     * @param[out] output The array to read samples into. Must hold 3 * maxSamples values.
+     * @param[in] maxSamples The maximum number of samples to read
+     * @return The number of samples read
+     */
+    size_t readBuffer(int16_t* output, size_t maxSamples)
+    {
+        size_t samples = this->beginBufferRead(getBufferSampleCount(), maxSamples);
+
+        if (samples != 0)
+        {
+            char* words = reinterpret_cast<char*>(output);
+            Transport::readRegister(
+                Register::BUF_READ, words, samples * this->getBufferBytesPerSample());
+            this->unpackBufferSamples(words, output, samples);
+        }
+
+        return samples;
+    }
+};
+
+#endif
@@ -1,36 +1,251 @@
 #include "KX134Base.h"
+#include "KX134SampleRing.h"
 
 #include <inttypes.h>
-#include <math.h>
 
-/** Set to 1 to enable debug printouts */
-#define KX134_DEBUG 0
+#include "mbed_trace.h"
+
+#define TRACE_GROUP "KX134"
+
+#ifndef KX134_USE_CMSIS_DSP
+/** Set to 1 to use CMSIS-DSP for the block conversion kernels */
+#define KX134_USE_CMSIS_DSP 0
+#endif
+
+#if KX134_USE_CMSIS_DSP
+#include "arm_math.h"
+#endif
+
+/**
+ * Number of clean registers a burst write may rewrite to join two dirty registers. Rewriting a
+ * register is cheaper than the address and chip select overhead of another transaction.
+ */
+#define FLUSH_MAX_GAP 3
+
+constexpr std::chrono::microseconds KX134Base::RESET_TIME;
+constexpr uint32_t KX134Base::INT1_FLAG;
+constexpr uint32_t KX134Base::INT2_FLAG;
+constexpr size_t KX134Base::BUFFER_BYTES_PER_SAMPLE;
+constexpr size_t KX134Base::BUFFER_BYTES_PER_SAMPLE_8BIT;
+constexpr size_t KX134Base::BUFFER_MAX_SAMPLES_16BIT;
+constexpr size_t KX134Base::BUFFER_MAX_SAMPLES;
+constexpr float KX134Base::GRAVS_PER_LSB[4];
+constexpr KX134Base::Register KX134Base::SHADOW_FIRST;
+constexpr KX134Base::Register KX134Base::SHADOW_LAST;
+constexpr size_t KX134Base::SHADOW_SIZE;
+constexpr size_t KX134Base::REGISTER_COUNT;
 
 KX134Base::KX134Base()
-    : res(1)
-    , drdye_enable(1)
-    , gsel { 0, 0 }
-    , tdte_enable(0)
-    , tpe_enable(0)
-    , iir_bypass(0)
-    , lpro(0)
-    , fstup(1)
-    , osa { 0, 1, 1, 0 }
+    : _offsets { 0, 0, 0 }
+    , _shadow {}
+    , _shadowDirty {}
+    , _cacheStats { 0, 0, 0 }
+    , _busStats { 0, 0 }
+#if KX134_INSTRUMENTATION
+    , _profile {}
+#endif
+    , _operating(false)
+    , _interruptPins { nullptr, nullptr }
+    , _interruptTimeUs { 0, 0 }
+    , _interruptCount { 0, 0 }
+    , _anchoredInterruptCount(0)
+    , _sampleIndex(0)
+    , _bufferDrained(true)
+    , _levelTimeUs(0)
+    , _anchorDrained(true)
+    , _sampleClockHz(0.0f)
+    , _initState(InitState::IDLE)
+    , _resetStartUs(0)
+    , _timeToReadyUs(0)
+    , _initQueue(nullptr)
+{
+}
+
+KX134Base::~KX134Base()
 {
+    delete _interruptPins[0];
+    delete _interruptPins[1];
 }
 
+bool KX134Base::init() { return configureBus() && reset(); }
+
 bool KX134Base::reset()
+{
+    startReset();
+
+    // software reset time
+    wait_us(RESET_TIME.count());
+
+    return completeReset();
+}
+
+KX134Base::StartResult KX134Base::warmStart(const Config& config)
+{
+    if (!configureBus())
+    {
+        _initState = InitState::FAILED;
+        return StartResult::FAILED;
+    }
+
+    const uint32_t startUs = timeUs();
+
+    if (checkExistence())
+    {
+        loadShadowRegisters();
+
+        if (_operating && matchesConfig(config))
+        {
+            tr_info("Already configured, resuming without reset");
+
+            // the samples taken so far have no anchors on this boot
+            _sampleClock.restart();
+            _timeToReadyUs = timeUs() - startUs;
+            _initState = InitState::READY;
+
+            return StartResult::RESUMED;
+        }
+    }
+
+    if (!reset())
+    {
+        return StartResult::FAILED;
+    }
+
+    applyConfig(config);
+    return StartResult::RESET;
+}
+
+bool KX134Base::matchesConfig(const Config& config) const
+{
+    for (size_t index = 0; index < SHADOW_SIZE; ++index)
+    {
+        if ((_shadow[index] ^ config._values[index]) & config._masks[index])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool KX134Base::startInit()
+{
+    if (!configureBus())
+    {
+        _initState = InitState::FAILED;
+        return false;
+    }
+
+    startReset();
+    return true;
+}
+
+bool KX134Base::startInit(EventQueue& queue, InitCallback onReady)
+{
+    if (!startInit())
+    {
+        if (onReady)
+        {
+            onReady(false);
+        }
+        return false;
+    }
+
+    _initQueue = &queue;
+    _onInitReady = onReady;
+    if (queue.call_in(std::chrono::duration_cast<std::chrono::milliseconds>(RESET_TIME),
+            this,
+            &KX134Base::onResetTimer)
+        == 0)
+    {
+        tr_error("StartInit: could not post the reset event, the queue is full");
+        _initState = InitState::FAILED;
+        if (onReady)
+        {
+            onReady(false);
+        }
+        return false;
+    }
+
+    return true;
+}
+
+void KX134Base::startReset()
 {
     // write registers to start reset
     writeRegisterOneByte(Register::INTERNAL_0X7F, 0x00);
     writeRegisterOneByte(Register::CNTL2, 0x00);
     writeRegisterOneByte(Register::CNTL2, 0x80);
 
-    // software reset time
-    wait_us(2000);
+    _resetStartUs = timeUs();
+    _timeToReadyUs = 0;
+    _initState = InitState::RESETTING;
+}
+
+KX134Base::InitState KX134Base::pollReset()
+{
+    if (_initState == InitState::RESETTING
+        && timeUs() - _resetStartUs >= static_cast<uint32_t>(RESET_TIME.count()))
+    {
+        completeReset();
+    }
+
+    return _initState;
+}
+
+KX134Base::InitState KX134Base::getInitState() const { return _initState; }
+
+std::chrono::microseconds KX134Base::getTimeToReady() const
+{
+    return std::chrono::microseconds(_timeToReadyUs);
+}
 
+bool KX134Base::configureBus() { return true; }
+
+void KX134Base::onResetTimer()
+{
+    InitState state = pollReset();
+
+    // the timer has millisecond ticks, so it may fire a little early against the MCU clock
+    if (state == InitState::RESETTING)
+    {
+        if (_initQueue->call_in(std::chrono::milliseconds(1), this, &KX134Base::onResetTimer) != 0)
+        {
+            return;
+        }
+
+        tr_error("OnResetTimer: could not post the reset event, the queue is full");
+        _initState = InitState::FAILED;
+        state = InitState::FAILED;
+    }
+
+    if (_onInitReady)
+    {
+        _onInitReady(state == InitState::READY);
+    }
+}
+
+bool KX134Base::completeReset()
+{
     // check existence
-    return checkExistence();
+    if (!checkExistence())
+    {
+        _initState = InitState::FAILED;
+        return false;
+    }
+
+    loadShadowRegisters();
+    _sampleClock.restart();
+
+    // stage the driver defaults (High-Performance mode, Data Ready Engine, Fast Start). They are
+    // written along with the first setting change.
+    setShadowBits(Register::CNTL1, CNTL1_RES | CNTL1_DRDYE, CNTL1_RES | CNTL1_DRDYE);
+    setShadowBits(Register::ODCNTL, ODCNTL_FSTUP, ODCNTL_FSTUP);
+
+    _timeToReadyUs = timeUs() - _resetStartUs;
+    _initState = InitState::READY;
+
+    return true;
 }
 
 bool KX134Base::checkExistence()
@@ -39,14 +254,9 @@ bool KX134Base::checkExistence()
     char whoami;
     readRegisterOneByte(Register::WHO_AM_I, whoami);
 
-#if KX134_DEBUG
-    printf("Checking existence: WHO_AM_I returned 0x%X", whoami);
-#endif
     if (whoami != 0x46)
     {
-#if KX134_DEBUG
-        printf(" but expected 0x46\r\n");
-#endif
+        tr_warn("WHO_AM_I returned 0x%X but expected 0x46", whoami);
         return false; // WHO_AM_I is incorrect
     }
 
@@ -54,20 +264,13 @@ bool KX134Base::checkExistence()
     char cotr;
     readRegisterOneByte(Register::COTR, cotr);
 
-#if KX134_DEBUG
-    printf(" and COTR returned 0x%X", cotr);
-#endif
     if (cotr != 0x55)
     {
-#if KX134_DEBUG
-        printf(" but expected 0x55\r\n");
-#endif
+        tr_warn("COTR returned 0x%X but expected 0x55", cotr);
         return false; // COTR is incorrect
     }
 
-#if KX134_DEBUG
-    printf("\r\nSuccessfully checked existence\r\n");
-#endif
+    tr_debug("Successfully checked existence");
 
     return true;
 }
@@ -81,13 +284,22 @@ void KX134Base::getAccelerations(int16_t* output)
     // one-by-one
     readRegister(Register::XOUT_L, words, 6);
 
-    output[0] = convertTo16BitValue(words[0], words[1]) + _offsets[0];
-    output[1] = convertTo16BitValue(words[2], words[3]) + _offsets[1];
-    output[2] = convertTo16BitValue(words[4], words[5]) + _offsets[2];
+    unpackSamples(words, output, 1);
 
-#if KX134_DEBUG
-    printf("Got accelerations: x=%d, y=%d, z=%d\r\n", output[0], output[1], output[2]);
-#endif
+    tr_debug("Got accelerations: x=%d, y=%d, z=%d", output[0], output[1], output[2]);
+}
+
+void KX134Base::getAdpOutputs(int16_t* output, int16_t* accelerations)
+{
+    // XADP..ZADP directly precede XOUT..ZOUT, so both can be read in one burst
+    char words[12];
+    readRegister(Register::XADP_L, words, accelerations != nullptr ? 12 : 6);
+
+    unpackSamples(words, output, 1, false);
+    if (accelerations != nullptr)
+    {
+        unpackSamples(words + 6, accelerations, 1);
+    }
 }
 
 bool KX134Base::dataReady()
@@ -95,101 +307,564 @@ bool KX134Base::dataReady()
     char buf;
     readRegisterOneByte(Register::INS2, buf);
 
-#if KX134_DEBUG
-    printf("Checking if data is ready: expected 0x10, received 0x%X\r\n", buf);
-#endif
+    tr_debug("Checking if data is ready: expected 0x10, received 0x%X", buf);
 
     return (buf & (1 << 4)); // bit4 should be set
 }
 
 float KX134Base::convertRawToGravs(int16_t lsbValue) const
 {
-    if (gsel[1] && gsel[0])
+    return (float)lsbValue * getGravsPerLsb();
+}
+
+void KX134Base::convertRawToGravs(const int16_t* input, float* output, size_t count) const
+{
+    const float scale = getGravsPerLsb();
+
+#if KX134_USE_CMSIS_DSP
+    // q15 to float divides by 32768, so fold that back into the scale
+    arm_q15_to_float(input, output, count);
+    arm_scale_f32(output, scale * 32768.0f, output, count);
+#else
+    for (size_t i = 0; i < count; ++i)
+    {
+        output[i] = (float)input[i] * scale;
+    }
+#endif
+}
+
+void KX134Base::convertRawToGravsQ15(const int16_t* input, int16_t* output, size_t count) const
+{
+    // +-8g needs a shift of 3 to reach the +-64g scale, +-64g needs none
+    const int8_t shift = 3 - ((getShadowRegister(Register::CNTL1) & CNTL1_GSEL) >> 3);
+
+#if KX134_USE_CMSIS_DSP
+    arm_shift_q15(input, -shift, output, count);
+#else
+    for (size_t i = 0; i < count; ++i)
     {
-        // +-64g
-        return (float)lsbValue * 0.00195f;
+        output[i] = input[i] >> shift;
     }
-    else if (gsel[1] && !gsel[0])
+#endif
+}
+
+void KX134Base::convertRawToGravsQ31(const int16_t* input, int32_t* output, size_t count) const
+{
+    // Q15 at +-64g is a shift of 16 to Q31, and each smaller range needs one less
+    const int8_t shift = 13 + ((getShadowRegister(Register::CNTL1) & CNTL1_GSEL) >> 3);
+
+    for (size_t i = 0; i < count; ++i)
     {
-        // +-32g
-        return (float)lsbValue * 0.00098f;
+        output[i] = static_cast<int32_t>(static_cast<uint32_t>(input[i]) << shift);
     }
-    else if (!gsel[1] && gsel[0])
+}
+
+float KX134Base::getGravsPerLsb() const
+{
+    return GRAVS_PER_LSB[(getShadowRegister(Register::CNTL1) & CNTL1_GSEL) >> 3];
+}
+
+void KX134Base::setAccelOffsets(int16_t* offsets) { memcpy(_offsets, offsets, sizeof(_offsets)); }
+
+void KX134Base::setAccelRange(Range range)
+{
+    tr_debug("Setting range to 0x%" PRIx8, static_cast<uint8_t>(range));
+
+    setShadowBits(Register::CNTL1, CNTL1_GSEL, static_cast<uint8_t>(range) << 3);
+    flushRegisters();
+}
+
+KX134Base::Range KX134Base::getAccelRange()
+{
+    ++_cacheStats.cachedReads;
+    return static_cast<Range>((getShadowRegister(Register::CNTL1) & CNTL1_GSEL) >> 3);
+}
+
+float KX134Base::setOutputDataRateHz(uint32_t hz)
+{
+    tr_debug("Setting ODR to %" PRIu32 " hz", hz);
+
+    const OutputDataRate odr = outputDataRateFromHz(hz);
+    setOutputDataRate(odr);
+
+    return outputDataRateToHz(odr);
+}
+
+void KX134Base::setOutputDataRate(OutputDataRate odr)
+{
+    setOutputDataRateBytes(static_cast<uint8_t>(odr));
+}
+
+void KX134Base::setOutputDataRateBytes(uint8_t byteHz)
+{
+    tr_debug("Setting ODR to 0x%x byte-wise, that should be %f hz",
+        byteHz,
+        outputDataRateToHz(static_cast<OutputDataRate>(byteHz & ODCNTL_OSA)));
+
+    setShadowBits(Register::ODCNTL, ODCNTL_OSA, byteHz);
+    flushRegisters();
+}
+
+uint8_t KX134Base::getOutputDataRateBytes()
+{
+    ++_cacheStats.cachedReads;
+    return getShadowRegister(Register::ODCNTL) & ODCNTL_OSA;
+}
+
+KX134Base::RegisterCacheStats KX134Base::getRegisterCacheStats() const { return _cacheStats; }
+
+KX134Base::BusStats KX134Base::getBusStats() const { return _busStats; }
+
+#if KX134_INSTRUMENTATION
+KX134Base::BusProfile KX134Base::getBusProfile() const
+{
+    BusProfile profile = _profile;
+    profile.totals = _busStats;
+    return profile;
+}
+
+void KX134Base::resetBusProfile()
+{
+    _profile = {};
+    _busStats = { 0, 0 };
+}
+#endif
+
+void KX134Base::applyConfig(const Config& config)
+{
+    for (size_t index = 0; index < SHADOW_SIZE; ++index)
     {
-        // +-16g
-        return (float)lsbValue * 0.00049f;
+        if (config._masks[index] != 0)
+        {
+            setShadowBits(static_cast<Register>(static_cast<uint8_t>(SHADOW_FIRST) + index),
+                config._masks[index],
+                config._values[index]);
+        }
     }
-    else if (!gsel[1] && !gsel[0])
+
+    flushRegisters();
+}
+
+void KX134Base::enableBuffer(BufferMode mode, uint8_t watermark, BufferResolution resolution)
+{
+    tr_debug("Enabling %u-bit buffer in mode 0x%" PRIx8 " with watermark %" PRIu8,
+        resolution == BufferResolution::RES_16BIT ? 16u : 8u,
+        static_cast<uint8_t>(mode),
+        watermark);
+
+    applyConfig(Config().buffer(mode, watermark, resolution));
+}
+
+void KX134Base::disableBuffer()
+{
+    tr_debug("Disabling buffer");
+
+    applyConfig(Config().noBuffer());
+}
+
+bool KX134Base::bufferTriggered()
+{
+    char status;
+    readRegisterOneByte(Register::BUF_STATUS_2, status);
+    return status & BUF_STATUS_2_BUF_TRIG;
+}
+
+KX134Base::BufferResolution KX134Base::getBufferResolution() const
+{
+    return getShadowRegister(Register::BUF_CNTL2) & BUF_CNTL2_BRES ? BufferResolution::RES_16BIT
+                                                                   : BufferResolution::RES_8BIT;
+}
+
+size_t KX134Base::getBufferCapacity() const
+{
+    return getBufferResolution() == BufferResolution::RES_16BIT ? BUFFER_MAX_SAMPLES_16BIT
+                                                                : BUFFER_MAX_SAMPLES;
+}
+
+size_t KX134Base::getBufferBytesPerSample() const
+{
+    return getBufferResolution() == BufferResolution::RES_16BIT ? BUFFER_BYTES_PER_SAMPLE
+                                                                : BUFFER_BYTES_PER_SAMPLE_8BIT;
+}
+
+void KX134Base::unpackBufferSamples(const char* words, int16_t* output, size_t samples) const
+{
+    if (getBufferResolution() == BufferResolution::RES_16BIT)
     {
-        // +-8g
-        return (float)lsbValue * 0.00024f;
+        unpackSamples(words, output, samples, !bufferHoldsAdp());
     }
     else
     {
-        return 0;
+        unpackSamples8Bit(words, output, samples, !bufferHoldsAdp());
     }
 }
 
-void KX134Base::setAccelOffsets(int16_t* offsets) { memcpy(_offsets, offsets, sizeof(_offsets)); }
+bool KX134Base::bufferHoldsAdp() const
+{
+    return (getShadowRegister(Register::CNTL5) & CNTL5_ADPE)
+        && (getShadowRegister(Register::ADP_CNTL2) & ADP_CNTL2_BUF_SEL);
+}
 
-void KX134Base::setAccelRange(Range range)
+void KX134Base::clearBuffer()
+{
+    // any write to BUF_CLEAR empties the buffer
+    writeRegisterOneByte(Register::BUF_CLEAR, 0x00);
+    _bufferDrained = true;
+    _anchorDrained = true;
+
+    // the discarded samples must not count towards the next period measurement
+    _sampleClock.restart();
+}
+
+size_t KX134Base::getBufferSampleCount()
+{
+    // SMP_LEV<9:0> is the number of bytes in the buffer, split over BUF_STATUS_1 and BUF_STATUS_2
+    char status[2];
+    readRegister(Register::BUF_STATUS_1, status, 2);
+
+    size_t bytes = static_cast<uint8_t>(status[0]) | ((status[1] & 0b11) << 8);
+
+    tr_debug("Buffer holds %u bytes", static_cast<unsigned>(bytes));
+
+    return bytes / getBufferBytesPerSample();
+}
+
+size_t KX134Base::readBuffer(int16_t* output, size_t maxSamples)
 {
-#if KX134_DEBUG
-    printf("Setting range to 0x%" PRIx8 "\r\n", static_cast<uint8_t>(range));
+    size_t samples = beginBufferRead(getBufferSampleCount(), maxSamples);
+    readBufferSamples(output, samples);
+
+    return samples;
+}
+
+size_t KX134Base::beginBufferRead(size_t level, size_t maxSamples)
+{
+#if KX134_INSTRUMENTATION
+    // a full Trigger mode buffer holds the complete capture, no samples were lost
+    if (level >= getBufferCapacity()
+        && (getShadowRegister(Register::BUF_CNTL2) & BUF_CNTL2_BM)
+            != static_cast<uint8_t>(BufferMode::TRIGGER))
+    {
+        ++_profile.bufferOverruns;
+    }
 #endif
 
-    enableRegisterWriting();
+    // every sample counted in the level was taken by now, however long the burst read takes
+    _levelTimeUs = timeUs();
+    _bufferDrained = level <= maxSamples;
+    return level <= maxSamples ? level : maxSamples;
+}
+
+void KX134Base::readBufferSamples(int16_t* output, size_t samples)
+{
+    if (samples == 0)
+    {
+        return;
+    }
+
+    // BUF_READ does not auto-increment, so one burst drains consecutive samples. The raw bytes
+    // are read straight into output and converted in place.
+    char* words = reinterpret_cast<char*>(output);
+    readRegister(Register::BUF_READ, words, samples * getBufferBytesPerSample());
+    unpackBufferSamples(words, output, samples);
 
-    gsel[0] = static_cast<uint8_t>(range) & 0b01;
-    gsel[1] = static_cast<uint8_t>(range) & 0b10;
+    tr_debug("Read %u samples from buffer", static_cast<unsigned>(samples));
+}
+
+size_t KX134Base::readFrames(KX134Frame* output, size_t maxSamples)
+{
+    static_assert(sizeof(KX134Frame) >= 3 * sizeof(int16_t), "A frame must hold a raw sample");
 
-    uint8_t writeByte = (1 << 7) | (res << 6) | (drdye_enable << 5) | (gsel[1] << 4)
-        | (gsel[0] << 3) | (tdte_enable << 2) | (tpe_enable);
-    // reserved bit 1, PC1 bit must be enabled
+    // The raw samples are read into the start of output and expanded into frames from the back:
+    // frame i only overlaps raw samples at or after i, which are already converted. This keeps a
+    // second BUFFER_MAX_SAMPLES buffer off the caller's stack.
+    int16_t* samples = reinterpret_cast<int16_t*>(output);
+    size_t count = readAvailable(samples, maxSamples);
+    uint32_t first = anchorSamples(count);
 
-    writeRegisterOneByte(Register::CNTL1, writeByte);
+    for (size_t i = count; i-- > 0;)
+    {
+        int16_t sample[3];
+        memcpy(sample, samples + 3 * i, sizeof(sample));
+        output[i] = { _sampleClock.timestamp(first + i), sample[0], sample[1], sample[2] };
+    }
+
+    return count;
 }
 
-void KX134Base::setOutputDataRateHz(uint32_t hz)
+size_t KX134Base::drainToRing(KX134SampleRing& ring)
 {
-#if KX134_DEBUG
-    printf("Setting ODR to %" PRIu32 " hz\r\n", hz);
+    int16_t samples[BUFFER_MAX_SAMPLES * 3];
+    size_t count = readAvailable(samples, BUFFER_MAX_SAMPLES);
+    uint32_t first = anchorSamples(count);
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        bool stored = ring.push({ _sampleClock.timestamp(first + i),
+            samples[3 * i],
+            samples[3 * i + 1],
+            samples[3 * i + 2] });
+
+#if KX134_INSTRUMENTATION
+        _profile.droppedFrames += !stored;
+#else
+        (void)stored;
 #endif
+    }
 
-    // calculate byte representation from new polling rate
-    // bytes = log2(32*rate/25)
+    return count;
+}
 
-    double new_rate = (double)hz;
+const KX134SampleClock& KX134Base::getSampleClock() const { return _sampleClock; }
 
-    double bytes_double = log2((32.f / 25.f) * new_rate);
-    uint8_t bytes_int = (uint8_t)ceil(bytes_double);
+size_t KX134Base::readAvailable(int16_t* output, size_t maxSamples)
+{
+    if (getShadowRegister(Register::BUF_CNTL2) & BUF_CNTL2_BUFE)
+    {
+        return readBuffer(output, maxSamples > BUFFER_MAX_SAMPLES ? BUFFER_MAX_SAMPLES : maxSamples);
+    }
 
-    setOutputDataRateBytes(bytes_int);
+    if (maxSamples == 0)
+    {
+        return 0;
+    }
+
+    _levelTimeUs = timeUs();
+    getAccelerations(output);
+    return 1;
 }
 
-void KX134Base::setOutputDataRateBytes(uint8_t byteHz)
+uint32_t KX134Base::anchorSamples(size_t count)
 {
-#if KX134_DEBUG
-    printf("Setting ODR to 0x%x byte-wise\r\n", byteHz);
-    printf("That should be %f hz\r\n", pow(2, byteHz) * 25.0 / 32.0);
+    uint32_t first = _sampleIndex;
+    _sampleIndex += count;
+
+    float nominalHz = outputDataRateToHz(
+        static_cast<OutputDataRate>(getShadowRegister(Register::ODCNTL) & ODCNTL_OSA));
+    if (nominalHz != _sampleClockHz)
+    {
+        _sampleClock.reset(nominalHz);
+        _sampleClockHz = nominalHz;
+    }
+
+    // the interrupt that reports new samples: watermark when buffering, data-ready otherwise
+    bool buffered = getShadowRegister(Register::BUF_CNTL2) & BUF_CNTL2_BUFE;
+    uint8_t source = buffered ? INT_WATERMARK : INT_DATA_READY;
+
+    // samples left behind by a read make the samples of the following reads older than the
+    // interrupts and reads that report them
+    const bool drainedBefore = !buffered || _anchorDrained;
+    const bool drained = !buffered || _bufferDrained;
+    _anchorDrained = drained;
+
+    for (int i = 0; i < 2; ++i)
+    {
+        InterruptPin pin = i == 0 ? InterruptPin::INT1 : InterruptPin::INT2;
+        Register routing = i == 0 ? Register::INC4 : Register::INC6;
+        if (!interruptEnabled(pin) || !(getShadowRegister(routing) & source))
+        {
+            continue;
+        }
+
+        // read the time and count of the same interrupt, should another one fire meanwhile
+        uint32_t interruptCount;
+        uint32_t interruptTimeUs;
+#if KX134_INSTRUMENTATION
+        uint32_t attempts = 0;
+#endif
+        do
+        {
+            interruptCount = _interruptCount[i];
+            interruptTimeUs = _interruptTimeUs[i];
+#if KX134_INSTRUMENTATION
+            ++attempts;
 #endif
+        } while (interruptCount != _interruptCount[i]);
+
+#if KX134_INSTRUMENTATION
+        _profile.retries += attempts - 1;
+        if (interruptCount - _anchoredInterruptCount > 1)
+        {
+            _profile.missedInterrupts += interruptCount - _anchoredInterruptCount - 1;
+        }
+#endif
+
+        // the interrupt fired when the watermark-th sample after the previous read was taken.
+        // If several fired since, reads were missed and the sample it reported is unknown, as it
+        // is if the previous read left samples behind.
+        if (interruptCount - _anchoredInterruptCount == 1 && drainedBefore)
+        {
+            uint32_t reported = buffered ? getShadowRegister(Register::BUF_CNTL1) : 1;
+            _sampleClock.anchor(interruptTimeUs, first + reported - 1);
+        }
+        _anchoredInterruptCount = interruptCount;
+        return first;
+    }
+
+    // no interrupt: if the read drained the buffer, its newest sample was taken just before the
+    // level was read
+    if (count > 0 && drained)
+    {
+        _sampleClock.anchor(_levelTimeUs, first + count - 1);
+    }
+    return first;
+}
+
+void KX134Base::enableInterrupt(InterruptPin pin, PinName mcuPin, uint8_t sources, bool latched)
+{
+    const uint8_t index = static_cast<uint8_t>(pin);
+
+    tr_debug("Routing sources 0x%" PRIX8 " to INT%d", sources, index + 1);
+
+    // stop listening while the pin is reconfigured
+    delete _interruptPins[index];
+    _interruptPins[index] = nullptr;
+
+    // pin enabled, active high, latched or pulsed. PWSEL (INC1 only) stays at 50us pulses.
+    setShadowBits(pin == InterruptPin::INT1 ? Register::INC1 : Register::INC5,
+        INC_IEN | INC_IEA | INC_IEL,
+        INC_IEN | INC_IEA | (latched ? 0 : INC_IEL));
+    setShadowBits(pin == InterruptPin::INT1 ? Register::INC4 : Register::INC6, 0xFF, sources);
+    flushRegisters();
+
+    _interruptFlags.clear(pin == InterruptPin::INT1 ? INT1_FLAG : INT2_FLAG);
+
+    // without an MCU pin, the interrupt line is driven by calling handleInterrupt()
+    if (mcuPin != NC)
+    {
+        _interruptPins[index] = new InterruptIn(mcuPin);
+        _interruptPins[index]->rise(pin == InterruptPin::INT1
+                ? callback(this, &KX134Base::onInt1)
+                : callback(this, &KX134Base::onInt2));
+    }
+}
+
+void KX134Base::disableInterrupt(InterruptPin pin)
+{
+    const uint8_t index = static_cast<uint8_t>(pin);
+
+    delete _interruptPins[index];
+    _interruptPins[index] = nullptr;
+
+    setShadowBits(pin == InterruptPin::INT1 ? Register::INC1 : Register::INC5, INC_IEN, 0);
+    setShadowBits(pin == InterruptPin::INT1 ? Register::INC4 : Register::INC6, 0xFF, 0);
+    flushRegisters();
+}
+
+uint32_t KX134Base::getInterruptTimeUs(InterruptPin pin) const
+{
+    return _interruptTimeUs[pin == InterruptPin::INT1 ? 0 : 1];
+}
+
+uint32_t KX134Base::getTimeUs() { return timeUs(); }
+
+bool KX134Base::interruptEnabled(InterruptPin pin) const
+{
+    return getShadowRegister(pin == InterruptPin::INT1 ? Register::INC1 : Register::INC5)
+        & INC_IEN;
+}
+
+void KX134Base::attachInterruptCallback(Callback<void(InterruptPin)> callback)
+{
+    _interruptCallback = callback;
+}
+
+uint32_t KX134Base::waitForInterrupt(uint32_t flags, Kernel::Clock::duration_u32 timeout)
+{
+    uint32_t fired = _interruptFlags.wait_any_for(flags, timeout);
+
+    if (fired & osFlagsError)
+    {
+        return 0; // timed out
+    }
+
+    return fired & flags;
+}
+
+void KX134Base::clearInterrupts()
+{
+    char buf;
+    readRegisterOneByte(Register::INT_REL, buf);
+}
+
+uint8_t KX134Base::getInterruptSources(uint8_t* directions)
+{
+    char status[2];
+    readRegister(Register::INS2, status, 2);
+
+    if (directions != nullptr)
+    {
+        *directions = status[1] & MOTION_ANY;
+    }
+
+    return decodeInterruptSources(status[0], status[1]);
+}
+
+uint8_t KX134Base::decodeInterruptSources(uint8_t ins2, uint8_t ins3)
+{
+    // INS2 shares the InterruptSource layout except for the tap status
+    uint8_t sources =
+        ins2 & (INT_TILT | INT_DATA_READY | INT_WATERMARK | INT_BUFFER_FULL | INT_FREE_FALL);
+    sources |= (ins2 & INS2_TDTS) ? INT_TAP : 0;
+    sources |= (ins3 & INS3_WUFS) ? INT_WAKE_UP : 0;
+    sources |= (ins3 & INS3_BTS) ? INT_BACK_TO_SLEEP : 0;
+
+    return sources;
+}
+
+KX134Base::Events KX134Base::readEvents()
+{
+    // TSCP, TSPP, INS1, INS2, INS3, STATUS_REG, INT_REL
+    char status[7];
+    readRegister(Register::TSCP, status, 7);
+
+    Events events;
+    events.sources = decodeInterruptSources(status[3], status[4]);
+    events.tap = static_cast<TapType>((status[3] & INS2_TDTS) >> 2);
+    events.tapDirection = status[2] & MOTION_ANY;
+    events.tiltPosition = status[0] & TILT_ANY;
+    events.previousTiltPosition = status[1] & TILT_ANY;
+    events.wakeUpDirection = status[4] & MOTION_ANY;
+
+    return events;
+}
+
+void KX134Base::sleep()
+{
+    // CNTL5 commands are accepted while operating
+    writeRegisterOneByte(Register::CNTL5, getShadowRegister(Register::CNTL5) | CNTL5_MAN_SLEEP);
+}
 
-    enableRegisterWriting();
+void KX134Base::wake()
+{
+    writeRegisterOneByte(Register::CNTL5, getShadowRegister(Register::CNTL5) | CNTL5_MAN_WAKE);
+}
 
-    osa[0] = byteHz & 0b0001;
-    osa[1] = byteHz & 0b0010;
-    osa[2] = byteHz & 0b0100;
-    osa[3] = byteHz & 0b1000;
+bool KX134Base::isAwake()
+{
+    char status;
+    readRegisterOneByte(Register::STATUS_REG, status);
+    return status & STATUS_REG_WAKE;
+}
 
-    uint8_t writeByte = (iir_bypass << 7) | (lpro << 6) | (fstup << 5) | (osa[3] << 3)
-        | (osa[2] << 2) | (osa[1] << 1) | osa[0];
-    // reserved bit 4
+void KX134Base::handleInterrupt(InterruptPin pin)
+{
+    int index = pin == InterruptPin::INT1 ? 0 : 1;
+    _interruptTimeUs[index] = timeUs();
+    ++_interruptCount[index];
 
-    writeRegisterOneByte(Register::ODCNTL, writeByte);
+    _interruptFlags.set(pin == InterruptPin::INT1 ? INT1_FLAG : INT2_FLAG);
 
-    disableRegisterWriting();
+    if (_interruptCallback)
+    {
+        _interruptCallback(pin);
+    }
 }
 
+void KX134Base::onInt1() { handleInterrupt(InterruptPin::INT1); }
+
+void KX134Base::onInt2() { handleInterrupt(InterruptPin::INT2); }
+
 void KX134Base::readRegisterOneByte(Register addr, char &rx_buf)
 {
     readRegister(addr, &rx_buf);
@@ -211,40 +886,374 @@ int16_t KX134Base::read16BitValue(Register lowAddr, Register highAddr)
     return convertTo16BitValue(lowWord, highWord);
 }
 
-int16_t KX134Base::convertTo16BitValue(uint8_t low, uint8_t high)
+uint32_t KX134Base::timeUs()
 {
-    // combine low & high words
-    uint16_t val2sComplement = (static_cast<uint16_t>(high << 8)) | low;
-    int16_t value = static_cast<int16_t>(val2sComplement);
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        HighResClock::now().time_since_epoch())
+        .count();
+}
 
-#if KX134_DEBUG
-    printf(
-        "Converting low (%d) and high (%d) to get 16 bit value (%d)\r\n", low, high, value);
-#endif
+size_t KX134Base::shadowIndex(Register addr)
+{
+    MBED_ASSERT(addr >= SHADOW_FIRST && addr <= SHADOW_LAST);
+    return static_cast<uint8_t>(addr) - static_cast<uint8_t>(SHADOW_FIRST);
+}
+
+uint8_t KX134Base::getShadowRegister(Register addr) const { return _shadow[shadowIndex(addr)]; }
 
-    return value;
+void KX134Base::setShadowBits(Register addr, uint8_t mask, uint8_t value)
+{
+    const size_t index = shadowIndex(addr);
+    const uint8_t updated = (_shadow[index] & ~mask) | (value & mask);
+
+    if (updated == _shadow[index])
+    {
+        ++_cacheStats.skippedWrites;
+        return;
+    }
+
+    _shadow[index] = updated;
+    _shadowDirty[index / 32] |= 1UL << (index % 32);
 }
 
-void KX134Base::enableRegisterWriting()
+void KX134Base::flushRegisters()
 {
-#if KX134_DEBUG
-    printf("Enabling register writing\r\n");
-#endif
-    uint8_t writeByte = (0 << 7) | (res << 6) | (drdye_enable << 5) | (gsel[1] << 4)
-        | (gsel[0] << 3) | (tdte_enable << 2) | (tpe_enable);
+    // settings are always applied in operating mode
+    const size_t cntl1 = shadowIndex(Register::CNTL1);
+    if (!(_shadow[cntl1] & CNTL1_PC1))
+    {
+        _shadow[cntl1] |= CNTL1_PC1;
+        _shadowDirty[cntl1 / 32] |= 1UL << (cntl1 % 32);
+    }
+
+    bool dirty = false;
+    for (uint32_t word : _shadowDirty)
+    {
+        dirty |= word != 0;
+    }
+
+    if (!dirty)
+    {
+        // no stand-by/operate toggle needed
+        _cacheStats.skippedWrites += 2;
+        return;
+    }
+
+    tr_debug("Flushing dirty registers");
+
+    // settings may only be changed in stand-by
+    if (_operating)
+    {
+        writeRegisterOneByte(Register::CNTL1, _shadow[cntl1] & ~CNTL1_PC1);
+        ++_cacheStats.writes;
+    }
+
+    // write runs of dirty registers as auto-incrementing bursts
+    auto isDirty = [this](size_t index) { return _shadowDirty[index / 32] & (1UL << (index % 32)); };
+
+    size_t index = cntl1 + 1;
+    while (index < SHADOW_SIZE)
+    {
+        if (!isDirty(index))
+        {
+            ++index;
+            continue;
+        }
 
-    writeRegisterOneByte(Register::CNTL1, writeByte);
+        // extend the run over dirty registers and short gaps of clean, rewritable ones
+        size_t end = index + 1;
+        for (size_t next = end; next < SHADOW_SIZE && next - end <= FLUSH_MAX_GAP
+             && isBurstWritable(next);
+             ++next)
+        {
+            if (isDirty(next))
+            {
+                end = next + 1;
+            }
+        }
+
+        writeRegister(static_cast<Register>(static_cast<uint8_t>(SHADOW_FIRST) + index),
+            reinterpret_cast<char*>(_shadow + index),
+            nullptr,
+            end - index);
+        ++_cacheStats.writes;
+
+        index = end;
+    }
+
+    // CNTL1 goes last, restoring operating mode
+    writeRegisterOneByte(Register::CNTL1, _shadow[cntl1]);
+    ++_cacheStats.writes;
+
+    memset(_shadowDirty, 0, sizeof(_shadowDirty));
+    _operating = true;
 }
 
-void KX134Base::disableRegisterWriting()
+bool KX134Base::isBurstWritable(size_t index)
 {
-#if KX134_DEBUG
-    printf("Disabling register writing\r\n");
-#endif
+    const uint8_t addr = static_cast<uint8_t>(SHADOW_FIRST) + index;
+
+    return (addr >= static_cast<uint8_t>(Register::CNTL1)
+               && addr <= static_cast<uint8_t>(Register::INC6))
+        || (addr >= static_cast<uint8_t>(Register::TILT_TIMER)
+            && addr <= static_cast<uint8_t>(Register::FFCNTL))
+        || (addr >= static_cast<uint8_t>(Register::TILT_ANGLE_LL)
+            && addr <= static_cast<uint8_t>(Register::LP_CNTL2))
+        || (addr >= static_cast<uint8_t>(Register::WUFTH)
+            && addr <= static_cast<uint8_t>(Register::WUFC))
+        || (addr >= static_cast<uint8_t>(Register::SELF_TEST)
+            && addr <= static_cast<uint8_t>(Register::BUF_CNTL2))
+        || (addr >= static_cast<uint8_t>(Register::ADP_CNTL1)
+            && addr <= static_cast<uint8_t>(Register::ADP_CNTL13))
+        // ADP_CNTL14..ADP_CNTL17 are reserved
+        || (addr >= static_cast<uint8_t>(Register::ADP_CNTL18)
+            && addr <= static_cast<uint8_t>(Register::ADP_CNTL19));
+}
+
+void KX134Base::loadShadowRegisters()
+{
+    char* shadow = reinterpret_cast<char*>(_shadow);
+
+    // two bursts around BUF_READ, since reading it would pop the sample buffer
+    readRegister(SHADOW_FIRST,
+        shadow,
+        static_cast<uint8_t>(Register::BUF_CLEAR) - static_cast<uint8_t>(SHADOW_FIRST) + 1);
+    readRegister(Register::ADP_CNTL1,
+        shadow + shadowIndex(Register::ADP_CNTL1),
+        static_cast<uint8_t>(SHADOW_LAST) - static_cast<uint8_t>(Register::ADP_CNTL1) + 1);
+
+    _shadow[shadowIndex(Register::CNTL2)] &= ~CNTL2_COMMANDS;
+    _shadow[shadowIndex(Register::CNTL5)] &= ~(CNTL5_MAN_WAKE | CNTL5_MAN_SLEEP);
+    _shadow[shadowIndex(Register::BUF_READ)] = 0;
+
+    memset(_shadowDirty, 0, sizeof(_shadowDirty));
+    _operating = _shadow[shadowIndex(Register::CNTL1)] & CNTL1_PC1;
+}
+
+KX134Base::Config::Config()
+    : _values {}
+    , _masks {}
+{
+}
+
+KX134Base::Config& KX134Base::Config::range(Range range)
+{
+    return set(Register::CNTL1, CNTL1_GSEL, static_cast<uint8_t>(range) << 3);
+}
+
+KX134Base::Config& KX134Base::Config::outputDataRateBytes(uint8_t byteHz)
+{
+    return set(Register::ODCNTL, ODCNTL_OSA, byteHz);
+}
+
+KX134Base::Config& KX134Base::Config::outputDataRate(OutputDataRate odr)
+{
+    return outputDataRateBytes(static_cast<uint8_t>(odr));
+}
+
+KX134Base::Config& KX134Base::Config::highPerformance(bool enable)
+{
+    return set(Register::CNTL1, CNTL1_RES, enable ? CNTL1_RES : 0);
+}
+
+KX134Base::Config& KX134Base::Config::dataReadyEngine(bool enable)
+{
+    return set(Register::CNTL1, CNTL1_DRDYE, enable ? CNTL1_DRDYE : 0);
+}
+
+KX134Base::Config& KX134Base::Config::tapEngine(bool enable)
+{
+    return set(Register::CNTL1, CNTL1_TDTE, enable ? CNTL1_TDTE : 0);
+}
+
+KX134Base::Config& KX134Base::Config::tiltEngine(bool enable)
+{
+    return set(Register::CNTL1, CNTL1_TPE, enable ? CNTL1_TPE : 0);
+}
+
+KX134Base::Config& KX134Base::Config::tap(
+    TapRate rate, uint8_t directions, bool singleTap, bool doubleTap)
+{
+    tapEngine(true);
+    set(Register::CNTL3, CNTL3_OTDT, static_cast<uint8_t>(rate) << 3);
+    set(Register::INC3, INC3_TAP_MASK, directions & MOTION_ANY);
+    return set(Register::TDTRC,
+        TDTRC_DTRE | TDTRC_STRE,
+        (doubleTap ? TDTRC_DTRE : 0) | (singleTap ? TDTRC_STRE : 0));
+}
+
+KX134Base::Config& KX134Base::Config::tapThreshold(uint8_t low, uint8_t high)
+{
+    set(Register::TTH, 0xFF, high);
+    return set(Register::TTL, 0xFF, low);
+}
+
+KX134Base::Config& KX134Base::Config::tapTiming(const TapTiming& timing)
+{
+    set(Register::TDTC, 0xFF, timing.doubleTapInterval);
+    set(Register::FTD,
+        FTD_FTDH | FTD_FTDL,
+        (timing.maxDuration << 3) | (timing.minDuration & FTD_FTDL));
+    set(Register::STD, 0xFF, timing.doubleTapDuration);
+    set(Register::TLT, 0xFF, timing.latency);
+    return set(Register::TWS, 0xFF, timing.window);
+}
+
+KX134Base::Config& KX134Base::Config::tilt(TiltRate rate, uint8_t positions, uint8_t delay)
+{
+    tiltEngine(true);
+    set(Register::CNTL3, CNTL3_OTP, static_cast<uint8_t>(rate) << 6);
+    set(Register::CNTL2, CNTL2_TILT_MASK, positions & TILT_ANY);
+    return set(Register::TILT_TIMER, 0xFF, delay);
+}
+
+KX134Base::Config& KX134Base::Config::tiltAngles(uint8_t low, uint8_t high, uint8_t hysteresis)
+{
+    set(Register::TILT_ANGLE_LL, 0xFF, low);
+    set(Register::TILT_ANGLE_HL, 0xFF, high);
+    return set(Register::HYST_SET, HYST_SET_HYST, hysteresis);
+}
+
+KX134Base::Config& KX134Base::Config::iirBypass(bool bypass)
+{
+    return set(Register::ODCNTL, ODCNTL_IIR_BYPASS, bypass ? ODCNTL_IIR_BYPASS : 0);
+}
+
+KX134Base::Config& KX134Base::Config::lowPassRollOff(bool halfOdr)
+{
+    return set(Register::ODCNTL, ODCNTL_LPRO, halfOdr ? ODCNTL_LPRO : 0);
+}
+
+KX134Base::Config& KX134Base::Config::fastStartUp(bool enable)
+{
+    return set(Register::ODCNTL, ODCNTL_FSTUP, enable ? ODCNTL_FSTUP : 0);
+}
+
+KX134Base::Config& KX134Base::Config::buffer(
+    BufferMode mode, uint8_t watermark, BufferResolution resolution)
+{
+    const bool sixteenBit = resolution == BufferResolution::RES_16BIT;
+    const size_t capacity = sixteenBit ? BUFFER_MAX_SAMPLES_16BIT : BUFFER_MAX_SAMPLES;
+
+    set(Register::BUF_CNTL1, 0xFF, watermark > capacity ? capacity : watermark);
+    return set(Register::BUF_CNTL2,
+        BUF_CNTL2_BUFE | BUF_CNTL2_BRES | BUF_CNTL2_BFIE | BUF_CNTL2_BM,
+        BUF_CNTL2_BUFE | (sixteenBit ? BUF_CNTL2_BRES : 0) | static_cast<uint8_t>(mode));
+}
+
+KX134Base::Config& KX134Base::Config::noBuffer()
+{
+    return set(Register::BUF_CNTL2, BUF_CNTL2_BUFE, 0);
+}
+
+KX134Base::Config& KX134Base::Config::bufferFullInterrupt(bool enable)
+{
+    return set(Register::BUF_CNTL2, BUF_CNTL2_BFIE, enable ? BUF_CNTL2_BFIE : 0);
+}
+
+KX134Base::Config& KX134Base::Config::wakeUp(
+    WakeUpRate rate, uint16_t threshold, uint8_t delay, uint8_t directions, bool relative)
+{
+    set(Register::CNTL3, CNTL3_OWUF, static_cast<uint8_t>(rate));
+    set(Register::CNTL4, CNTL4_WUFE | CNTL4_TH_MODE, CNTL4_WUFE | (relative ? CNTL4_TH_MODE : 0));
+    set(Register::WUFTH, 0xFF, threshold & 0xFF);
+    set(Register::BTSWUFTH, BTSWUFTH_WUFTH, threshold >> 8);
+    set(Register::WUFC, 0xFF, delay);
+
+    // AOI = 0: any of the enabled directions wakes the KX134
+    return set(Register::INC2, 0x7F, directions & MOTION_ANY);
+}
+
+KX134Base::Config& KX134Base::Config::noWakeUp()
+{
+    return set(Register::CNTL4, CNTL4_WUFE, 0);
+}
+
+KX134Base::Config& KX134Base::Config::advancedDataPath(
+    OutputDataRate rate, AdpRmsAverage average, AdpOutput output)
+{
+    set(Register::CNTL5, CNTL5_ADPE, CNTL5_ADPE);
+    set(Register::ADP_CNTL1,
+        ADP_CNTL1_RMS_AVC | ADP_CNTL1_OADP,
+        (static_cast<uint8_t>(average) << 4) | static_cast<uint8_t>(rate));
+    return set(Register::ADP_CNTL2,
+        ADP_CNTL2_RMS_OSEL,
+        output == AdpOutput::RMS ? ADP_CNTL2_RMS_OSEL : 0);
+}
+
+KX134Base::Config& KX134Base::Config::noAdvancedDataPath()
+{
+    set(Register::CNTL5, CNTL5_ADPE, 0);
+    return set(Register::ADP_CNTL2, ADP_CNTL2_BUF_SEL | ADP_CNTL2_WB_ISEL, 0);
+}
+
+KX134Base::Config& KX134Base::Config::adpFilter1(const AdpFilter1Coefficients& coefficients)
+{
+    set(Register::ADP_CNTL2, ADP_CNTL2_FLT1_BYP, 0);
+    set(Register::ADP_CNTL3, ADP_F_1A, coefficients.oneOverA);
+
+    // B/A and C/A are 23-bit little-endian values
+    for (uint8_t i = 0; i < 3; ++i)
+    {
+        const uint8_t mask = i == 2 ? 0x7F : 0xFF;
+        set(static_cast<Register>(static_cast<uint8_t>(Register::ADP_CNTL4) + i),
+            mask,
+            coefficients.bOverA >> (8 * i));
+        set(static_cast<Register>(static_cast<uint8_t>(Register::ADP_CNTL7) + i),
+            mask,
+            coefficients.cOverA >> (8 * i));
+    }
+
+    set(Register::ADP_CNTL10, ADP_F_SH, coefficients.inputShift);
+    return set(Register::ADP_CNTL11,
+        ADP_CNTL11_F1_OSH,
+        coefficients.outputShift ? ADP_CNTL11_F1_OSH : 0);
+}
+
+KX134Base::Config& KX134Base::Config::noAdpFilter1()
+{
+    return set(Register::ADP_CNTL2, ADP_CNTL2_FLT1_BYP, ADP_CNTL2_FLT1_BYP);
+}
+
+KX134Base::Config& KX134Base::Config::adpFilter2(
+    const AdpFilter2Coefficients& coefficients, bool highPass)
+{
+    set(Register::ADP_CNTL2,
+        ADP_CNTL2_FLT2_BYP | ADP_CNTL2_F2_HP,
+        highPass ? ADP_CNTL2_F2_HP : 0);
+    set(Register::ADP_CNTL11, ADP_F_1A, coefficients.oneOverA);
+
+    // B/A is a 15-bit little-endian value
+    set(Register::ADP_CNTL12, 0xFF, coefficients.bOverA);
+    set(Register::ADP_CNTL13, 0x7F, coefficients.bOverA >> 8);
+
+    set(Register::ADP_CNTL18, ADP_F_SH, coefficients.inputShift);
+    return set(Register::ADP_CNTL19, ADP_F_SH, coefficients.outputShift);
+}
+
+KX134Base::Config& KX134Base::Config::noAdpFilter2()
+{
+    return set(Register::ADP_CNTL2, ADP_CNTL2_FLT2_BYP, ADP_CNTL2_FLT2_BYP);
+}
+
+KX134Base::Config& KX134Base::Config::adpToBuffer(bool enable)
+{
+    return set(Register::ADP_CNTL2, ADP_CNTL2_BUF_SEL, enable ? ADP_CNTL2_BUF_SEL : 0);
+}
+
+KX134Base::Config& KX134Base::Config::adpToWakeUp(bool enable, bool rms)
+{
+    return set(Register::ADP_CNTL2,
+        ADP_CNTL2_WB_ISEL | ADP_CNTL2_RMS_WB_OSEL,
+        (enable ? ADP_CNTL2_WB_ISEL : 0) | (rms ? ADP_CNTL2_RMS_WB_OSEL : 0));
+}
+
+KX134Base::Config& KX134Base::Config::set(Register addr, uint8_t mask, uint8_t value)
+{
+    const size_t index = shadowIndex(addr);
 
-    uint8_t writeByte = (1 << 7) | (res << 6) | (drdye_enable << 5) | (gsel[1] << 4)
-        | (gsel[0] << 3) | (tdte_enable << 2) | (tpe_enable);
-    // reserved bit 1, PC1 bit must be enabled
+    _values[index] = (_values[index] & ~mask) | (value & mask);
+    _masks[index] |= mask;
 
-    writeRegisterOneByte(Register::CNTL1, writeByte);
+    return *this;
 }
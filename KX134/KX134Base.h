@@ -15,9 +15,16 @@
 #ifndef KX134BASE_H
 #define KX134BASE_H
 
-#define KX134_DEBUG 0
+#ifndef KX134_INSTRUMENTATION
+/** Set to 1 to profile bus traffic per register, time on the bus, errors, drops and retries */
+#define KX134_INSTRUMENTATION 0
+#endif
 
 #include "mbed.h"
+#include "KX134SampleClock.h"
+
+class KX134SampleRing;
+struct KX134Frame;
 
 /**
  * @brief Base class for KX134 driver
@@ -26,407 +33,2174 @@ class KX134Base
 {
 public:
     /**
-     * @brief The possible acceleration ranges
+     * @brief The possible acceleration ranges
+     */
+    enum class Range : uint8_t
+    {
+        RANGE_8G = 0b00,
+        RANGE_16G = 0b01,
+        RANGE_32G = 0b10,
+        RANGE_64G = 0b11
+    };
+
+    /**
+     * @brief The possible Output Data Rates (OSA bits in ODCNTL)
+     *
+     * Rates above 400Hz are only available in High-Performance mode.
+     */
+    enum class OutputDataRate : uint8_t
+    {
+        ODR_0_781HZ = 0,
+        ODR_1_563HZ = 1,
+        ODR_3_125HZ = 2,
+        ODR_6_25HZ = 3,
+        ODR_12_5HZ = 4,
+        ODR_25HZ = 5,
+        ODR_50HZ = 6,
+        ODR_100HZ = 7,
+        ODR_200HZ = 8,
+        ODR_400HZ = 9,
+        ODR_800HZ = 10,
+        ODR_1600HZ = 11,
+        ODR_3200HZ = 12,
+        ODR_6400HZ = 13,
+        ODR_12800HZ = 14,
+        ODR_25600HZ = 15
+    };
+
+    /**
+     * @brief The possible sample buffer operating modes (BM bits in BUF_CNTL2)
+     */
+    enum class BufferMode : uint8_t
+    {
+        /** Collect samples until the buffer is full, then stop */
+        FIFO = 0b00,
+        /** Collect samples until the buffer is full, then discard the oldest sample */
+        STREAM = 0b01,
+        /** Collect samples around a trigger event */
+        TRIGGER = 0b10
+    };
+
+    /**
+     * @brief The possible sample buffer resolutions (BRES bit in BUF_CNTL2)
+     *
+     * 8-bit samples hold the upper byte of each axis. They halve the bus traffic per sample and
+     * double the buffer capacity, and are returned in the same LSB units as 16-bit samples.
+     */
+    enum class BufferResolution : uint8_t
+    {
+        RES_8BIT = 0,
+        RES_16BIT = 1
+    };
+
+    /**
+     * @brief The physical interrupt pins of the KX134
+     */
+    enum class InterruptPin : uint8_t
+    {
+        INT1 = 0,
+        INT2 = 1
+    };
+
+    /**
+     * @brief Interrupt sources that can be routed to a physical interrupt pin
+     *
+     * These match the bit layout of INC4 (INT1) and INC6 (INT2), and may be combined with |.
+     */
+    enum InterruptSource : uint8_t
+    {
+        INT_TILT = 1 << 0,
+        INT_WAKE_UP = 1 << 1,
+        INT_TAP = 1 << 2,
+        INT_BACK_TO_SLEEP = 1 << 3,
+        INT_DATA_READY = 1 << 4,
+        INT_WATERMARK = 1 << 5,
+        INT_BUFFER_FULL = 1 << 6,
+        INT_FREE_FALL = 1 << 7
+    };
+
+    /**
+     * @brief The possible wake-up function output data rates (OWUF bits in CNTL3)
+     *
+     * The rate at which the wake-up function samples while the KX134 is in the sleep state.
+     */
+    enum class WakeUpRate : uint8_t
+    {
+        WUF_0_781HZ = 0,
+        WUF_1_563HZ = 1,
+        WUF_3_125HZ = 2,
+        WUF_6_25HZ = 3,
+        WUF_12_5HZ = 4,
+        WUF_25HZ = 5,
+        WUF_50HZ = 6,
+        WUF_100HZ = 7
+    };
+
+    /**
+     * @brief Axis directions of motion detected by the wake-up function
+     *
+     * These match the bit layout of INC2 and INS3, and may be combined with |.
+     */
+    enum MotionDirection : uint8_t
+    {
+        MOTION_Z_POSITIVE = 1 << 0,
+        MOTION_Z_NEGATIVE = 1 << 1,
+        MOTION_Y_POSITIVE = 1 << 2,
+        MOTION_Y_NEGATIVE = 1 << 3,
+        MOTION_X_POSITIVE = 1 << 4,
+        MOTION_X_NEGATIVE = 1 << 5,
+        MOTION_ANY = 0x3F
+    };
+
+    /**
+     * @brief The possible Tap/Double-Tap Engine output data rates (OTDT bits in CNTL3)
+     */
+    enum class TapRate : uint8_t
+    {
+        TAP_12_5HZ = 4,
+        TAP_25HZ = 5,
+        TAP_50HZ = 0,
+        TAP_100HZ = 1,
+        TAP_200HZ = 2,
+        TAP_400HZ = 3,
+        TAP_800HZ = 6,
+        TAP_1600HZ = 7
+    };
+
+    /**
+     * @brief The possible Tilt Position Engine output data rates (OTP bits in CNTL3)
+     */
+    enum class TiltRate : uint8_t
+    {
+        TILT_1_563HZ = 0,
+        TILT_6_25HZ = 1,
+        TILT_12_5HZ = 2,
+        TILT_50HZ = 3
+    };
+
+    /**
+     * @brief Tilt positions, named after the side facing up or down
+     *
+     * These match the bit layout of CNTL2, TSCP and TSPP, and may be combined with |.
+     */
+    enum TiltPosition : uint8_t
+    {
+        TILT_FACE_UP = 1 << 0,
+        TILT_FACE_DOWN = 1 << 1,
+        TILT_UP = 1 << 2,
+        TILT_DOWN = 1 << 3,
+        TILT_RIGHT = 1 << 4,
+        TILT_LEFT = 1 << 5,
+        TILT_ANY = 0x3F
+    };
+
+    /**
+     * @brief The kinds of tap reported by the Tap/Double-Tap Engine (TDTS bits in INS2)
+     */
+    enum class TapType : uint8_t
+    {
+        NONE = 0,
+        SINGLE = 1,
+        DOUBLE = 2
+    };
+
+    /**
+     * @brief Timing of the Tap/Double-Tap Engine, in tap engine samples (see TapRate)
+     *
+     * See the KX134-1211 Technical Reference Manual for the detection algorithm. The power-on
+     * values are { 0x78, 0x02, 0x14, 0x24, 0x28, 0xA0 }.
+     */
+    struct TapTiming
+    {
+        /** @brief Minimum time between the taps of a double tap (TDTC) */
+        uint8_t doubleTapInterval;
+
+        /** @brief Minimum time a tap must last (FTDL, 3 bits) */
+        uint8_t minDuration;
+
+        /** @brief Maximum time a tap may last (FTDH, 5 bits) */
+        uint8_t maxDuration;
+
+        /** @brief Maximum total time of the taps of a double tap (STD) */
+        uint8_t doubleTapDuration;
+
+        /** @brief Time after a tap during which no other tap is detected (TLT) */
+        uint8_t latency;
+
+        /** @brief Time window in which a single or double tap must complete (TWS) */
+        uint8_t window;
+    };
+
+    /**
+     * @brief Events decoded from the interrupt status registers, see readEvents()
+     */
+    struct Events
+    {
+        /** @brief The pending InterruptSource bits */
+        uint8_t sources;
+
+        /** @brief The kind of tap detected, if sources has INT_TAP */
+        TapType tap;
+
+        /** @brief The MotionDirection of the tap, if sources has INT_TAP */
+        uint8_t tapDirection;
+
+        /** @brief The current TiltPosition */
+        uint8_t tiltPosition;
+
+        /** @brief The previous TiltPosition, if sources has INT_TILT */
+        uint8_t previousTiltPosition;
+
+        /** @brief The MotionDirection bits that caused the wake-up, if sources has INT_WAKE_UP */
+        uint8_t wakeUpDirection;
+    };
+
+    /**
+     * @brief The number of samples averaged by the Advanced Data Path RMS block (RMS_AVC bits)
+     */
+    enum class AdpRmsAverage : uint8_t
+    {
+        RMS_2 = 0,
+        RMS_4 = 1,
+        RMS_8 = 2,
+        RMS_16 = 3,
+        RMS_32 = 4,
+        RMS_64 = 5,
+        RMS_128 = 6,
+        RMS_256 = 7
+    };
+
+    /**
+     * @brief What the Advanced Data Path outputs in XADP..ZADP (ADP_RMS_OSEL bit)
+     */
+    enum class AdpOutput : uint8_t
+    {
+        /** The output of the filter chain */
+        FILTERED = 0,
+        /** The RMS of the filter chain output */
+        RMS = 1
+    };
+
+    /**
+     * @brief Coefficients of the Advanced Data Path's first (second-order) filter
+     *
+     * These are the fixed-point register values produced by Kionix's ADP filter calculator, see
+     * the KX134-1211 Technical Reference Manual.
+     */
+    struct AdpFilter1Coefficients
+    {
+        /** @brief 1/A coefficient (ADP_F1_1A, 7 bits) */
+        uint8_t oneOverA;
+
+        /** @brief B/A coefficient (ADP_F1_BA, 23 bits) */
+        uint32_t bOverA;
+
+        /** @brief C/A coefficient (ADP_F1_CA, 23 bits) */
+        uint32_t cOverA;
+
+        /** @brief Input scale shift (ADP_F1_ISH, 5 bits) */
+        uint8_t inputShift;
+
+        /** @brief Output scale shift (ADP_F1_OSH, 1 bit) */
+        bool outputShift;
+    };
+
+    /**
+     * @brief Coefficients of the Advanced Data Path's second (first-order) filter
+     *
+     * As AdpFilter1Coefficients.
+     */
+    struct AdpFilter2Coefficients
+    {
+        /** @brief 1/A coefficient (ADP_F2_1A, 7 bits) */
+        uint8_t oneOverA;
+
+        /** @brief B/A coefficient (ADP_F2_BA, 15 bits) */
+        uint16_t bOverA;
+
+        /** @brief Input scale shift (ADP_F2_ISH, 5 bits) */
+        uint8_t inputShift;
+
+        /** @brief Output scale shift (ADP_F2_OSH, 5 bits) */
+        uint8_t outputShift;
+    };
+
+    /**
+     * @brief The states of an asynchronous init or reset, see startInit()
+     */
+    enum class InitState : uint8_t
+    {
+        /** No reset has been started */
+        IDLE,
+        /** Waiting for the software reset to complete */
+        RESETTING,
+        /** The KX134 responded after the reset and is ready */
+        READY,
+        /** The bus could not be configured or the KX134 did not respond after the reset */
+        FAILED
+    };
+
+    /**
+     * @brief The outcomes of warmStart()
+     */
+    enum class StartResult : uint8_t
+    {
+        /** The KX134 was already running the configuration and was left untouched */
+        RESUMED,
+        /** The KX134 was reset and configured */
+        RESET,
+        /** The KX134 did not respond */
+        FAILED
+    };
+
+    /**
+     * @brief Function called when an asynchronous init completes
+     *
+     * Receives true if the KX134 is ready, false if the init failed.
+     */
+    typedef Callback<void(bool)> InitCallback;
+
+    /** @brief Time the KX134 takes to complete a software reset */
+    static constexpr std::chrono::microseconds RESET_TIME { 2000 };
+
+    /** @brief Event flag set when INT1 fires */
+    static constexpr uint32_t INT1_FLAG = 1 << 0;
+
+    /** @brief Event flag set when INT2 fires */
+    static constexpr uint32_t INT2_FLAG = 1 << 1;
+
+    /**
+     * @brief Counters of the bus traffic made by the driver
+     */
+    struct BusStats
+    {
+        /** @brief Register read and write transactions */
+        uint32_t transactions;
+
+        /** @brief Bytes transferred, including the register address byte */
+        uint32_t bytes;
+    };
+
+    /**
+     * @brief Counters showing the bus transactions saved by the register shadow cache
+     */
+    struct RegisterCacheStats
+    {
+        /** @brief Register writes issued to the bus */
+        uint32_t writes;
+
+        /** @brief Register writes (including stand-by/operate toggles) skipped as no-ops */
+        uint32_t skippedWrites;
+
+        /** @brief Setting reads served from the cache instead of the bus */
+        uint32_t cachedReads;
+    };
+
+    /** @brief Number of register addresses, which are 7-bit */
+    static constexpr size_t REGISTER_COUNT = 128;
+
+    /**
+     * @brief Detailed counters of the driver's bus traffic and data losses. Only collected with
+     * KX134_INSTRUMENTATION.
+     */
+    struct BusProfile
+    {
+        /** @brief Transactions and bytes, as getBusStats() */
+        BusStats totals;
+
+        /** @brief Time spent in bus transactions in microseconds, wrapping around */
+        uint32_t busTimeUs;
+
+        /** @brief Transactions the transport reported as failed */
+        uint32_t errors;
+
+        /** @brief Interrupt bookkeeping reads repeated because the interrupt fired meanwhile */
+        uint32_t retries;
+
+        /** @brief Frames dropped because the sample ring was full */
+        uint32_t droppedFrames;
+
+        /** @brief Buffer reads that found the buffer full, so samples may have been lost */
+        uint32_t bufferOverruns;
+
+        /** @brief Data-ready or watermark interrupts that fired with no read in between */
+        uint32_t missedInterrupts;
+
+        /** @brief Read transactions, indexed by their first register address */
+        uint32_t reads[REGISTER_COUNT];
+
+        /** @brief Write transactions, indexed by their first register address */
+        uint32_t writes[REGISTER_COUNT];
+    };
+
+    class Config;
+
+    /** @brief Number of bytes in one buffered 16-bit XYZ sample */
+    static constexpr size_t BUFFER_BYTES_PER_SAMPLE = 6;
+
+    /** @brief Number of bytes in one buffered 8-bit XYZ sample */
+    static constexpr size_t BUFFER_BYTES_PER_SAMPLE_8BIT = 3;
+
+    /** @brief Maximum number of 16-bit XYZ samples held by the sample buffer */
+    static constexpr size_t BUFFER_MAX_SAMPLES_16BIT = 86;
+
+    /**
+     * @brief Maximum number of XYZ samples held by the sample buffer, reached at 8-bit resolution.
+     * Arrays sized for this hold a full buffer at either resolution.
+     */
+    static constexpr size_t BUFFER_MAX_SAMPLES = 171;
+
+public:
+    /**
+     * @brief Construct a new KX134Base
+     */
+    KX134Base();
+
+    /**
+     * @brief Destroy the KX134Base, releasing any interrupt pins
+     */
+    virtual ~KX134Base();
+
+    /**
+     * @brief Performs a software reset
+     *
+     * Blocks for RESET_TIME. See startReset() for the non-blocking equivalent.
+     *
+     * @return true if the reset was successful, false otherwise
+     */
+    bool reset();
+
+    /**
+     * @brief Initializes the KX134, skipping the software reset if it already runs a
+     * configuration
+     *
+     * After an MCU-only reboot, the KX134 may still be operating with the right settings. The
+     * register cache is then loaded from the KX134 and compared with config; if the KX134 is
+     * operating and every setting of config matches, it keeps sampling undisturbed, including
+     * the samples in its buffer. Otherwise it is reset as by init() and config is applied.
+     *
+     * Interrupt pins must be enabled again either way, which only rewrites routing registers
+     * that differ.
+     *
+     * @param[in] config The settings the KX134 should run with
+     * @return Whether the KX134 was resumed or reset, or StartResult::FAILED
+     */
+    StartResult warmStart(const Config& config);
+
+    /**
+     * @brief Returns if the KX134 holds every setting of a Config. Served from the register
+     * cache.
+     *
+     * @param[in] config The settings to compare
+     * @return true if all settings match, false otherwise
+     */
+    bool matchesConfig(const Config& config) const;
+
+    /**
+     * @brief Starts initializing the KX134 without waiting for its software reset
+     *
+     * Configures the bus and starts a software reset. Completion is checked by pollReset(), so
+     * several KX134s can be reset in parallel and the MCU can do other work in the meantime.
+     *
+     * @return true if the reset was started, false if the bus could not be configured
+     */
+    bool startInit();
+
+    /**
+     * @brief Starts initializing the KX134, completing on an EventQueue
+     *
+     * As startInit(), but the reset is completed by an event posted RESET_TIME later, which
+     * then calls onReady.
+     *
+     * @param[in] queue The EventQueue to complete the reset on
+     * @param[in] onReady The function to call once the KX134 is ready or the init failed. Called
+     * on the EventQueue, or immediately if the bus could not be configured or the event could not
+     * be posted. If the queue is full when the reset is polled again, the init fails.
+     * @return true if the reset was started, false if the bus could not be configured or the
+     * queue is full
+     */
+    bool startInit(EventQueue& queue, InitCallback onReady);
+
+    /**
+     * @brief Starts a software reset without waiting for it to complete
+     *
+     * Settings may not be changed until pollReset() returns InitState::READY.
+     */
+    void startReset();
+
+    /**
+     * @brief Completes a software reset started by startReset() once RESET_TIME has passed
+     *
+     * Does not block, and may be called repeatedly.
+     *
+     * @return InitState::RESETTING while waiting, then InitState::READY or InitState::FAILED
+     */
+    InitState pollReset();
+
+    /**
+     * @brief Returns the state of the last init or reset
+     *
+     * @return The current InitState
+     */
+    InitState getInitState() const;
+
+    /**
+     * @brief Returns the time the last init or reset took, from its start until the KX134 was
+     * found ready
+     *
+     * @return The time to ready, or 0 if the last reset has not completed
+     */
+    std::chrono::microseconds getTimeToReady() const;
+
+    /**
+     * @brief Verifies the KX134 unit is connected and functioning normally
+     *
+     * @return true if functioning normally, false otherwise. If false, call reset() and check
+     * again.
+     */
+    bool checkExistence();
+
+    /**
+     * @brief Reads the accelerations in LSB immediately
+     *
+     * @param[out] output The array to read accelerations into. output[0] is X acceleration,
+     * output[1] is Y accel, output[2] is Z accel.
+     */
+    void getAccelerations(int16_t* output);
+
+    /**
+     * @brief Reads the Advanced Data Path outputs (XADP..ZADP) in LSB immediately
+     *
+     * Offsets set by setAccelOffsets() are not applied. The ADP is configured with
+     * Config::advancedDataPath().
+     *
+     * @param[out] output The array to read the X, Y and Z ADP outputs into
+     * @param[out] accelerations If not nullptr, receives the accelerations as getAccelerations(),
+     * read in the same transaction
+     */
+    void getAdpOutputs(int16_t* output, int16_t* accelerations = nullptr);
+
+    /**
+     * @brief Returns if the unit is ready to read acceleration data
+     *
+     * @return true if ready, false otherwise
+     */
+    bool dataReady();
+
+    /**
+     * @brief Converts an LSB value to gravs
+     *
+     * Note:
+     * +-64g: 1LSB = 0.00195g
+     * +-32g: 1LSB = 0.00098g
+     * +-16g: 1LSB = 0.00049g
+     * +-8g: 1LSB = 0.00024g
+
+     * @param[in] lsbValue The value in LSB to convert to gravs
+     * @return The value in gravs
+     */
+    float convertRawToGravs(int16_t lsbValue) const;
+
+    /**
+     * @brief Converts a block of LSB values to gravs
+     *
+     * The scale for the current range is looked up once, so the loop is branch-free and can be
+     * vectorized. Uses CMSIS-DSP when KX134_USE_CMSIS_DSP is set to 1.
+     *
+     * @param[in] input The values in LSB to convert, e.g. a block returned by readBuffer()
+     * @param[out] output The array to write the values in gravs into. May not overlap input.
+     * @param[in] count The number of values to convert
+     */
+    void convertRawToGravs(const int16_t* input, float* output, size_t count) const;
+
+    /**
+     * @brief Converts a block of LSB values to Q15 fixed-point gravs
+     *
+     * The output is normalized to the widest range, so 0x7FFF is +64g regardless of the current
+     * range, and uses the nominal sensitivity (range / 32768 g per LSB). This reduces to a
+     * per-range arithmetic shift and needs no FPU.
+     *
+     * @param[in] input The values in LSB to convert
+     * @param[out] output The array to write the Q15 values (g / 64) into. May be the same as input.
+     * @param[in] count The number of values to convert
+     */
+    void convertRawToGravsQ15(const int16_t* input, int16_t* output, size_t count) const;
+
+    /**
+     * @brief Converts a block of LSB values to Q31 fixed-point gravs
+     *
+     * As convertRawToGravsQ15(), but without losing resolution at the smaller ranges.
+     *
+     * @param[in] input The values in LSB to convert
+     * @param[out] output The array to write the Q31 values (g / 64) into
+     * @param[in] count The number of values to convert
+     */
+    void convertRawToGravsQ31(const int16_t* input, int32_t* output, size_t count) const;
+
+    /**
+     * @brief Returns the scale used to convert LSB values to gravs at the current range
+     *
+     * @return The value of 1 LSB in gravs
+     */
+    float getGravsPerLsb() const;
+
+    /**
+     * @brief Set offsets that will be added to each acceleration reading before it is returned.
+     *
+     * @param[in] offsets array of 3 integers that will be added to the results
+     */
+    void setAccelOffsets(int16_t* offsets);
+
+    /**
+     * @brief Set acceleration range (8, 16, 32, or 64 gs)
+     *
+     * @param[in] range The Range to set the acceleration range to
+     */
+    void setAccelRange(Range range);
+
+    /**
+     * @brief Returns the acceleration range. Served from the register cache.
+     *
+     * @return The current Range
+     */
+    Range getAccelRange();
+
+    /**
+     * @brief Returns the slowest Output Data Rate that is at least a given rate
+     *
+     * @param[in] hz The minimum rate in Hz. Rates above 25600Hz select 25600Hz.
+     * @return The selected OutputDataRate
+     */
+    static constexpr OutputDataRate outputDataRateFromHz(uint32_t hz)
+    {
+        // each rate is 25 / 32 * 2^OSA Hz, so compare in units of 1/32 Hz
+        uint8_t osa = 0;
+        while (osa < static_cast<uint8_t>(OutputDataRate::ODR_25600HZ)
+            && (uint64_t { 25 } << osa) < uint64_t { 32 } * hz)
+        {
+            ++osa;
+        }
+        return static_cast<OutputDataRate>(osa);
+    }
+
+    /**
+     * @brief Returns the rate of an Output Data Rate in Hz
+     *
+     * @param[in] odr The OutputDataRate
+     * @return The rate in Hz
+     */
+    static constexpr float outputDataRateToHz(OutputDataRate odr)
+    {
+        return 25.0f / 32.0f * (1UL << static_cast<uint8_t>(odr));
+    }
+
+    /**
+     * @brief Set Output Data Rate from Hz
+     *
+     * Selects the slowest Output Data Rate that is at least the requested rate.
+     *
+     * @param[in] hz An integer representation of the ODR in Hz
+     * @return The selected rate in Hz
+     */
+    float setOutputDataRateHz(uint32_t hz);
+
+    /**
+     * @brief Set Output Data Rate from Hz, selected at compile time
+     *
+     * @tparam hz An integer representation of the ODR in Hz
+     * @return The selected rate in Hz
+     */
+    template <uint32_t hz> float setOutputDataRateHz()
+    {
+        static_assert(hz <= 25600, "The KX134 supports Output Data Rates up to 25600Hz");
+
+        constexpr OutputDataRate odr = outputDataRateFromHz(hz);
+        setOutputDataRate(odr);
+        return outputDataRateToHz(odr);
+    }
+
+    /**
+     * @brief Set Output Data Rate
+     *
+     * @param[in] odr The OutputDataRate to use
+     */
+    void setOutputDataRate(OutputDataRate odr);
+
+    /**
+     * @brief Set Output Data Rate Bitwise
+     *
+     * @param[in] byteHz A bit-wise representation of the ODR
+     */
+    void setOutputDataRateBytes(uint8_t byteHz);
+
+    /**
+     * @brief Returns the bit-wise Output Data Rate. Served from the register cache.
+     *
+     * @return The bit-wise representation of the ODR (OSA bits)
+     */
+    uint8_t getOutputDataRateBytes();
+
+    /**
+     * @brief Returns the bus transactions saved by the register cache
+     *
+     * @return The counters since construction
+     */
+    RegisterCacheStats getRegisterCacheStats() const;
+
+    /**
+     * @brief Returns the bus traffic made by the driver
+     *
+     * @return The counters since construction
+     */
+    BusStats getBusStats() const;
+
+#if KX134_INSTRUMENTATION
+    /**
+     * @brief Returns a snapshot of the bus profile
+     *
+     * Counters are updated without locking, so take the snapshot from the thread using the driver.
+     *
+     * @return The counters since construction or the last resetBusProfile()
+     */
+    BusProfile getBusProfile() const;
+
+    /**
+     * @brief Clears the bus profile, e.g. before profiling a section of firmware
+     */
+    void resetBusProfile();
+#endif
+
+    /**
+     * @brief Applies several settings at once
+     *
+     * All settings in the Config are written in a single stand-by/write/operate sequence, using
+     * burst writes across neighbouring registers, so the sensor stops sampling only once.
+     * Settings the Config does not mention keep their current values.
+     *
+     * @param[in] config The settings to apply
+     */
+    void applyConfig(const Config& config);
+
+    /**
+     * @brief Enables the sample buffer
+     *
+     * @param[in] mode The BufferMode to operate the buffer in
+     * @param[in] watermark The number of samples at which the watermark interrupt is raised.
+     * Clamped to the buffer capacity at the given resolution.
+     * @param[in] resolution The BufferResolution to store samples at
+     */
+    void enableBuffer(BufferMode mode, uint8_t watermark,
+        BufferResolution resolution = BufferResolution::RES_16BIT);
+
+    /**
+     * @brief Disables the sample buffer
+     */
+    void disableBuffer();
+
+    /**
+     * @brief Returns if the trigger event has occurred in the Trigger buffer mode (BUF_TRIG bit)
+     *
+     * Reset by clearBuffer().
+     *
+     * @return true if triggered, false otherwise
+     */
+    bool bufferTriggered();
+
+    /**
+     * @brief Returns the resolution of buffered samples. Served from the register cache.
+     *
+     * @return The current BufferResolution
+     */
+    BufferResolution getBufferResolution() const;
+
+    /**
+     * @brief Returns the number of samples the sample buffer holds at the current resolution
+     *
+     * @return BUFFER_MAX_SAMPLES_16BIT or BUFFER_MAX_SAMPLES
+     */
+    size_t getBufferCapacity() const;
+
+    /**
+     * @brief Returns if the sample buffer holds Advanced Data Path outputs instead of
+     * accelerations. Served from the register cache.
+     *
+     * @return true if ADP outputs are routed to the buffer, see Config::adpToBuffer()
+     */
+    bool bufferHoldsAdp() const;
+
+    /**
+     * @brief Discards all samples currently held in the sample buffer
+     */
+    void clearBuffer();
+
+    /**
+     * @brief Reads the number of complete XYZ samples currently held in the sample buffer
+     *
+     * @return The number of samples available to readBuffer()
+     */
+    size_t getBufferSampleCount();
+
+    /**
+     * @brief Drains samples from the sample buffer in a single burst read
+     *
+     * Samples are read oldest first. Offsets set by setAccelOffsets() are applied, as in
+     * getAccelerations().
+     *
+     * @param[out] output The array to read samples into. Must hold 3 * maxSamples values, stored
+     * as consecutive X, Y, Z triples.
+     * @param[in] maxSamples The maximum number of samples to read
+     * @return The number of samples read
+     */
+    size_t readBuffer(int16_t* output, size_t maxSamples);
+
+    /**
+     * @brief Reads the available samples as timestamped frames
+     *
+     * If the sample buffer is enabled, it is drained with readBuffer(). Otherwise, one sample is
+     * read with getAccelerations().
+     *
+     * Each frame is given the time it was taken, reconstructed by the sample clock (see
+     * getSampleClock()). When the watermark (buffer enabled) or data-ready (buffer disabled)
+     * interrupt is routed to an enabled pin, the time of the last interrupt anchors the newest
+     * sample the interrupt reported; otherwise the time the buffer level was read (or, without
+     * the buffer, the read started) anchors the newest sample read, so the transfer time does
+     * not delay it. Anchors spaced by a known number of samples give the actual output data
+     * rate, which spaces the samples in between. Reads that leave samples in the buffer, and
+     * interrupts following them, are not used as anchors: the samples are then timed from
+     * earlier anchors.
+     *
+     * @param[out] output The array to write frames into
+     * @param[in] maxSamples The maximum number of samples to read. At most BUFFER_MAX_SAMPLES are
+     * read.
+     * @return The number of frames read
+     */
+    size_t readFrames(KX134Frame* output, size_t maxSamples);
+
+    /**
+     * @brief Reads the available samples and pushes them into a sample ring
+     *
+     * As readFrames(). Intended to be called from the data-ready or watermark path (e.g. an
+     * EventQueue event posted by the interrupt callback), so consumers pop from the ring and never
+     * wait on the bus.
+     *
+     * @param[in] ring The ring to push into. Frames that do not fit are counted as dropped.
+     * @return The number of samples read
+     */
+    size_t drainToRing(KX134SampleRing& ring);
+
+    /**
+     * @brief Returns the clock that timestamps frames
+     *
+     * Its measured rate and drift compare the KX134's output data rate with the MCU clock.
+     *
+     * @return The sample clock
+     */
+    const KX134SampleClock& getSampleClock() const;
+
+    /**
+     * @brief Routes interrupt sources to a physical interrupt pin and starts listening to it
+     *
+     * The interrupt pin is driven active high. In pulsed mode (the default) each event produces
+     * one 50us pulse. In latched mode the pin stays asserted until clearInterrupts() is called.
+     *
+     * @param[in] pin The KX134 interrupt pin to configure
+     * @param[in] mcuPin The MCU pin the KX134 interrupt pin is connected to, or NC if the
+     * interrupt line is simulated by calling handleInterrupt()
+     * @param[in] sources The InterruptSource bits to route to the pin
+     * @param[in] latched true to latch the interrupt, false to pulse it
+     */
+    void enableInterrupt(InterruptPin pin, PinName mcuPin, uint8_t sources, bool latched = false);
+
+    /**
+     * @brief Stops routing interrupts to a physical interrupt pin and stops listening to it
+     *
+     * @param[in] pin The KX134 interrupt pin to disable
+     */
+    void disableInterrupt(InterruptPin pin);
+
+    /**
+     * @brief Returns if a physical interrupt pin is enabled
+     *
+     * @param[in] pin The KX134 interrupt pin to check
+     * @return true if enabled, false otherwise
+     */
+    bool interruptEnabled(InterruptPin pin) const;
+
+    /**
+     * @brief Attaches a function to be called whenever an interrupt pin fires
+     *
+     * The callback is executed in interrupt context, so it must not perform any bus
+     * transactions. Pass nullptr to detach.
+     *
+     * @param[in] callback The function to call with the pin that fired
+     */
+    void attachInterruptCallback(Callback<void(InterruptPin)> callback);
+
+    /**
+     * @brief Returns the time an interrupt pin last fired
+     *
+     * May be called from the interrupt callback.
+     *
+     * @param[in] pin The KX134 interrupt pin
+     * @return The MCU time in microseconds recorded by handleInterrupt(), wrapping around
+     */
+    uint32_t getInterruptTimeUs(InterruptPin pin) const;
+
+    /**
+     * @brief Returns the MCU time, on the clock interrupt times are recorded with
+     *
+     * @return The time in microseconds, wrapping around
+     */
+    uint32_t getTimeUs();
+
+    /**
+     * @brief Sleeps the calling thread until an interrupt pin fires
+     *
+     * The flags of the pins that fired are cleared before returning.
+     *
+     * @param[in] flags The combination of INT1_FLAG and INT2_FLAG to wait for
+     * @param[in] timeout The maximum time to wait
+     * @return The flags that fired, or 0 if the wait timed out
+     */
+    uint32_t waitForInterrupt(uint32_t flags = INT1_FLAG | INT2_FLAG,
+        Kernel::Clock::duration_u32 timeout = Kernel::wait_for_u32_forever);
+
+    /**
+     * @brief Releases latched interrupts by reading INT_REL
+     */
+    void clearInterrupts();
+
+    /**
+     * @brief Reads which interrupt sources are pending
+     *
+     * Reads INS2 and INS3 in one transaction. Pending sources are released by clearInterrupts().
+     *
+     * @param[out] directions If not nullptr, receives the MotionDirection bits that caused the
+     * last wake-up
+     * @return The pending InterruptSource bits
+     */
+    uint8_t getInterruptSources(uint8_t* directions = nullptr);
+
+    /**
+     * @brief Reads and decodes all pending events, releasing latched interrupts
+     *
+     * Reads TSCP through INT_REL in one transaction, so the events are released in the same
+     * transaction they are read in.
+     *
+     * @return The decoded Events
+     */
+    Events readEvents();
+
+    /**
+     * @brief Puts the KX134 in the sleep state, where only the wake-up function runs
+     *
+     * Takes effect immediately, without a stand-by cycle. Requires the wake-up function to be
+     * enabled, see Config::wakeUp().
+     */
+    void sleep();
+
+    /**
+     * @brief Puts the KX134 in the wake state, sampling at the output data rate
+     *
+     * Takes effect immediately, without a stand-by cycle.
+     */
+    void wake();
+
+    /**
+     * @brief Returns if the KX134 is in the wake state
+     *
+     * @return true if awake, false if in the sleep state
+     */
+    bool isAwake();
+
+    /**
+     * @brief Signals that an interrupt pin has fired
+     *
+     * Called from the interrupt pin's ISR. May also be called directly to simulate an interrupt
+     * line when no hardware pin is connected.
+     *
+     * @param[in] pin The KX134 interrupt pin that fired
+     */
+    void handleInterrupt(InterruptPin pin);
+
+    /**
+     * @brief Initializes the KX134
+     *
+     * Configures the bus and performs a software reset, blocking for RESET_TIME. See startInit()
+     * for the non-blocking equivalent.
+     *
+     * @return true if the init is successful, false otherwise
+     */
+    virtual bool init();
+
+protected:
+    /**
+     * @brief The list of registers
+     */
+    enum class Register : uint8_t
+    {
+        MAN_ID = 0x00,
+        PART_ID = 0x01,
+        XADP_L = 0x02,
+        XADP_H = 0x03,
+        YADP_L = 0x04,
+        YADP_H = 0x05,
+        ZADP_L = 0x06,
+        ZADP_H = 0x07,
+        XOUT_L = 0x08,
+        XOUT_H = 0x09,
+        YOUT_L = 0x0A,
+        YOUT_H = 0x0B,
+        ZOUT_L = 0x0C,
+        ZOUT_H = 0x0D,
+        COTR = 0x12,
+        WHO_AM_I = 0x13,
+        TSCP = 0x14,
+        TSPP = 0x15,
+        INS1 = 0x16,
+        INS2 = 0x17,
+        INS3 = 0x18,
+        STATUS_REG = 0x19,
+        INT_REL = 0x1A,
+        CNTL1 = 0x1B,
+        CNTL2 = 0x1C,
+        CNTL3 = 0x1D,
+        CNTL4 = 0x1E,
+        CNTL5 = 0x1F,
+        CNTL6 = 0x20,
+        ODCNTL = 0x21,
+        INC1 = 0x22,
+        INC2 = 0x23,
+        INC3 = 0x24,
+        INC4 = 0x25,
+        INC5 = 0x26,
+        INC6 = 0x27,
+        TILT_TIMER = 0x29,
+        TDTRC = 0x2A,
+        TDTC = 0x2B,
+        TTH = 0x2C,
+        TTL = 0x2D,
+        FTD = 0x2E,
+        STD = 0x2F,
+        TLT = 0x30,
+        TWS = 0x31,
+        FFTH = 0x32,
+        FFC = 0x33,
+        FFCNTL = 0x34,
+        TILT_ANGLE_LL = 0x37,
+        TILT_ANGLE_HL = 0x38,
+        HYST_SET = 0x39,
+        LP_CNTL1 = 0x3A,
+        LP_CNTL2 = 0x3B,
+        WUFTH = 0x49,
+        BTSWUFTH = 0x4A,
+        BTSTH = 0x4B,
+        BTSC = 0x4C,
+        WUFC = 0x4D,
+        SELF_TEST = 0x5D,
+        BUF_CNTL1 = 0x5E,
+        BUF_CNTL2 = 0x5F,
+        BUF_STATUS_1 = 0x60,
+        BUF_STATUS_2 = 0x61,
+        BUF_CLEAR = 0x62,
+        BUF_READ = 0x63,
+        ADP_CNTL1 = 0x64,
+        ADP_CNTL2 = 0x65,
+        ADP_CNTL3 = 0x66,
+        ADP_CNTL4 = 0x67,
+        ADP_CNTL5 = 0x68,
+        ADP_CNTL6 = 0x69,
+        ADP_CNTL7 = 0x6A,
+        ADP_CNTL8 = 0x6B,
+        ADP_CNTL9 = 0x6C,
+        ADP_CNTL10 = 0x6D,
+        ADP_CNTL11 = 0x6E,
+        ADP_CNTL12 = 0x6F,
+        ADP_CNTL13 = 0x70,
+        ADP_CNTL14 = 0x71,
+        ADP_CNTL15 = 0x72,
+        ADP_CNTL16 = 0x73,
+        ADP_CNTL17 = 0x74,
+        ADP_CNTL18 = 0x75,
+        ADP_CNTL19 = 0x76,
+        INTERNAL_0X7F = 0x7F
+    };
+
+protected:
+    /**
+     * @brief Reads a value from a low and high address and combines them to create a signed (2s
+     * complement) 16-bit integer
+     *
+     * @param[in] lowAddr The low address to read from
+     * @param[in] highAddr The high address to read from
+     * @return The signed representation of their value
+     */
+    int16_t read16BitValue(Register lowAddr, Register highAddr);
+
+    /**
+     * @brief Converts 2 8-bit unsigned integers to a single signed 16-bit (2s complement) integer
+     *
+     * @param[in] low The 8 lower bits
+     * @param[in] high The 8 upper bits
+     * @return The signed representation of their value
+     */
+    int16_t convertTo16BitValue(uint8_t low, uint8_t high) const;
+
+    /**
+     * @brief Converts raw little-endian XYZ samples as read from the bus and applies the offsets
+     *
+     * words and output may point to the same memory, in which case the conversion is done in
+     * place.
+     *
+     * @param[in] words The raw bytes, 6 per sample
+     * @param[out] output The array to write samples into, as consecutive X, Y, Z triples
+     * @param[in] samples The number of samples to convert
+     * @param[in] applyOffsets false to skip the offsets, e.g. for ADP outputs
+     */
+    void unpackSamples(
+        const char* words, int16_t* output, size_t samples, bool applyOffsets = true) const;
+
+    /**
+     * @brief Converts raw 8-bit XYZ samples as read from the bus and applies the offsets
+     *
+     * Each byte is the upper byte of a 16-bit value. words and output may point to the same
+     * memory, in which case the conversion is done in place.
+     *
+     * @param[in] words The raw bytes, 3 per sample
+     * @param[out] output The array to write samples into, as consecutive X, Y, Z triples
+     * @param[in] samples The number of samples to convert
+     * @param[in] applyOffsets false to skip the offsets, e.g. for ADP outputs
+     */
+    void unpackSamples8Bit(
+        const char* words, int16_t* output, size_t samples, bool applyOffsets = true) const;
+
+    /**
+     * @brief Converts raw samples read from the sample buffer, at the current buffer resolution
+     *
+     * @param[in] words The raw bytes
+     * @param[out] output The array to write samples into. May be the same as words.
+     * @param[in] samples The number of samples to convert
+     */
+    void unpackBufferSamples(const char* words, int16_t* output, size_t samples) const;
+
+    /**
+     * @brief Returns the number of bytes one buffered sample occupies at the current resolution
+     *
+     * @return BUFFER_BYTES_PER_SAMPLE or BUFFER_BYTES_PER_SAMPLE_8BIT
+     */
+    size_t getBufferBytesPerSample() const;
+
+    /**
+     * @brief Starts draining the sample buffer, given its level
+     *
+     * Does the bookkeeping shared by every path that drains the buffer: counts overruns and
+     * records when the level was read and whether the read leaves samples behind, which the
+     * sample clock needs (see readFrames()). Call it once per drain, right after reading the
+     * level.
+     *
+     * @param[in] level The number of samples in the buffer, e.g. from getBufferSampleCount()
+     * @param[in] maxSamples The maximum number of samples to read
+     * @return The number of samples to read
+     */
+    size_t beginBufferRead(size_t level, size_t maxSamples);
+
+    /**
+     * @brief Reads a known number of samples from the sample buffer, without reading its level
+     *
+     * @param[out] output The array to write samples into, as consecutive X, Y, Z triples
+     * @param[in] samples The number of samples to read. Must not exceed the buffer level.
+     */
+    void readBufferSamples(int16_t* output, size_t samples);
+
+    /**
+     * @brief Writes a given register 1 byte
+     * Convenience function, calls writeRegister()
+     *
+     * @param[in] addr The register to write to
+     * @param[in] tx_buf The data to write
+     * @param[out] rx_buf The response data to receive
+     */
+    void writeRegisterOneByte(Register addr, char tx_buf, char* rx_buf = nullptr);
+
+    /**
+     * @brief Reads 1 byte from a given register
+     * Convenience function, calls readRegister()
+     *
+     * @param[in] addr The register to read from
+     * @param[out] rx_buf The buffer to read into
+     */
+    void readRegisterOneByte(Register addr, char& rx_buf);
+
+    /**
+     * @brief Returns the time a bus transaction starts, to pass to countTransaction()
+     *
+     * @return The MCU time in microseconds, or 0 without KX134_INSTRUMENTATION
+     */
+    uint32_t transactionStart();
+
+    /**
+     * @brief Records a bus transaction in the BusStats and BusProfile. Called by the transports.
+     *
+     * @param[in] addr The first register transferred
+     * @param[in] write Whether the transaction wrote to the KX134
+     * @param[in] size The number of data bytes transferred, excluding the register address
+     * @param[in] startUs The time returned by transactionStart() before the transaction
+     * @param[in] failed Whether the transport reported an error
+     */
+    void countTransaction(Register addr, bool write, int size, uint32_t startUs,
+        bool failed = false);
+
+    /**
+     * @brief Prepares the transport before the KX134 is reset. Called by init() and startInit().
+     *
+     * @return true if the bus is ready, false otherwise
+     */
+    virtual bool configureBus();
+
+    /**
+     * @brief Returns the current MCU time used to timestamp interrupts and samples
+     *
+     * Called from interrupt context.
+     *
+     * @return The time in microseconds, wrapping around
+     */
+    virtual uint32_t timeUs();
+
+    /**
+     * @brief Reads a given register a given number of bytes
+     *
+     * @param[in] addr The register to read from
+     * @param[out] rx_buf The buffer to read into
+     * @param[in] size The number of bytes to read
+     */
+    virtual void readRegister(Register addr, char* rx_buf, int size = 1) = 0;
+
+    /**
+     * @brief Writes data to a given register
+     *
+     * @param[in] addr The register to write to
+     * @param[in] data The data to write
+     * @param[out] rx_buf The response to receive
+     * @param[in] size The number of bytes to write.
+     */
+    virtual void writeRegister(Register addr, char* data, char* rx_buf = nullptr, int size = 1) = 0;
+
+private:
+    /**
+     * @brief ISR attached to the INT1 pin
+     */
+    void onInt1();
+
+    /**
+     * @brief ISR attached to the INT2 pin
+     */
+    void onInt2();
+
+protected:
+    /**
+     * @brief Bits of the registers held in the shadow cache
+     *
+     * Note that to properly change the value of the CNTL, ODCNTL, INC and BUF_CNTL registers, the
+     * PC1 bit in CNTL1 register must first be set to “0”. flushRegisters() takes care of this.
+     */
+    enum RegisterBits : uint8_t
+    {
+        /**
+         * @brief Operating mode (PC1) bit of CNTL1
+         *
+         * PC1 = 0 – Stand-by mode, settings may be changed
+         * PC1 = 1 – High-Performance or Low Power operating mode
+         */
+        CNTL1_PC1 = 1 << 7,
+
+        /**
+         * @brief The RES bit of CNTL1 determines the performance mode
+         *
+         * RES = 0 – Low Power mode (higher noise, lower current, 16-bit output data)
+         * RES = 1 – High-Performance mode (lower noise, higher current, 16-bit output data)
+         */
+        CNTL1_RES = 1 << 6,
+
+        /**
+         * @brief Data Ready Engine enable bit of CNTL1
+         *
+         * DRDYE = 0 – Data Ready Engine is disabled
+         * DRDYE = 1 – Data Ready Engine is enabled
+         */
+        CNTL1_DRDYE = 1 << 5,
+
+        /**
+         * @brief G-range Select (GSEL) bits of CNTL1 select the acceleration range of the
+         * accelerometer outputs per Table 7. This range is also called a full-scale range of the
+         * accelerometer.
+         *
+         * GSEL1 | GSEL0 | Range
+         * ----- | ----- | -----
+         * 0     | 0     | +-8g
+         * 0     | 1     | +-16g
+         * 1     | 0     | +-32g
+         * 1     | 1     | +-64g
+         */
+        CNTL1_GSEL = 0b11 << 3,
+
+        /**
+         * @brief Tap/Double-Tap Engine (TDTE) enable bit of CNTL1
+         *
+         * TDTE = 0 – Tap/Double-Tap Engine is disabled
+         * TDTE = 1 – Tap/Double-Tap Engine is enabled
+         */
+        CNTL1_TDTE = 1 << 2,
+
+        /**
+         * @brief Tilt Position Engine (TPE) enable bit of CNTL1
+         *
+         * TPE = 0 – Tilt Position Engine is disabled
+         * TPE = 1 – Tilt Position Engine is enabled
+         */
+        CNTL1_TPE = 1 << 0,
+
+        /**
+         * @brief Tilt position mask bits of CNTL2, see TiltPosition
+         */
+        CNTL2_TILT_MASK = 0x3F,
+
+        /**
+         * @brief Tilt Position Engine output data rate (OTP) bits of CNTL3, see TiltRate
+         */
+        CNTL3_OTP = 0b11 << 6,
+
+        /**
+         * @brief Tap/Double-Tap Engine output data rate (OTDT) bits of CNTL3, see TapRate
+         */
+        CNTL3_OTDT = 0b111 << 3,
+
+        /**
+         * @brief Tap direction mask bits of INC3, see MotionDirection
+         */
+        INC3_TAP_MASK = 0x3F,
+
+        /**
+         * @brief Double tap (DTRE) and single tap (STRE) report enable bits of TDTRC
+         */
+        TDTRC_DTRE = 1 << 1,
+        TDTRC_STRE = 1 << 0,
+
+        /**
+         * @brief Tap duration limits of FTD: high limit (FTDH) and low limit (FTDL)
+         */
+        FTD_FTDH = 0b11111 << 3,
+        FTD_FTDL = 0b111,
+
+        /**
+         * @brief Hysteresis bits of HYST_SET. The upper bits are reserved.
+         */
+        HYST_SET_HYST = 0x3F,
+
+        /**
+         * @brief Software reset (SRST) and command test (COTC) bits of CNTL2. These are commands,
+         * not settings, and are never cached.
+         */
+        CNTL2_COMMANDS = 0b11 << 6,
+
+        /**
+         * @brief Wake-up function output data rate (OWUF) bits of CNTL3, see WakeUpRate
+         */
+        CNTL3_OWUF = 0b111,
+
+        /**
+         * @brief Wake-up threshold mode bit of CNTL4
+         *
+         * TH_MODE = 0 – absolute threshold
+         * TH_MODE = 1 – relative threshold, compared to the acceleration when the count started
+         */
+        CNTL4_TH_MODE = 1 << 6,
+
+        /**
+         * @brief Wake-up function enable bit of CNTL4
+         *
+         * WUFE = 0 – Wake-up function is disabled
+         * WUFE = 1 – Wake-up function is enabled
+         */
+        CNTL4_WUFE = 1 << 5,
+
+        /**
+         * @brief Manual wake (MAN_WAKE) and manual sleep (MAN_SLEEP) bits of CNTL5. These are
+         * commands, cleared by the KX134 once executed, and are never cached.
+         */
+        CNTL5_MAN_WAKE = 1 << 1,
+        CNTL5_MAN_SLEEP = 1 << 0,
+
+        /**
+         * @brief Advanced Data Path enable bit of CNTL5
+         *
+         * ADPE = 0 – Advanced Data Path is disabled
+         * ADPE = 1 – Advanced Data Path is enabled
+         */
+        CNTL5_ADPE = 1 << 4,
+
+        /**
+         * @brief Upper 3 bits of the wake-up threshold in BTSWUFTH (the lower 8 bits are WUFTH)
+         */
+        BTSWUFTH_WUFTH = 0b111,
+
+        /**
+         * @brief Tap/double-tap status (TDTS) bits of INS2
+         */
+        INS2_TDTS = 0b11 << 2,
+
+        /**
+         * @brief Wake-up (WUFS) and back-to-sleep (BTS) status bits of INS3
+         */
+        INS3_WUFS = 1 << 7,
+        INS3_BTS = 1 << 6,
+
+        /**
+         * @brief Wake state bit of STATUS_REG
+         *
+         * WAKE = 0 – sleep state
+         * WAKE = 1 – wake state
+         */
+        STATUS_REG_WAKE = 1 << 0,
+
+        /**
+         * @brief RMS averaging count (RMS_AVC) bits of ADP_CNTL1, see AdpRmsAverage
+         */
+        ADP_CNTL1_RMS_AVC = 0b111 << 4,
+
+        /**
+         * @brief Advanced Data Path output data rate (OADP) bits of ADP_CNTL1, encoded as OSA
+         */
+        ADP_CNTL1_OADP = 0b1111,
+
+        /**
+         * @brief Routing bits of ADP_CNTL2
+         *
+         * ADP_BUF_SEL – ADP outputs are stored in the sample buffer instead of accelerations
+         * ADP_WB_ISEL – the wake-up/back-to-sleep engines use the ADP outputs
+         * RMS_WB_OSEL – the wake-up/back-to-sleep engines use the RMS instead of the filter output
+         */
+        ADP_CNTL2_BUF_SEL = 1 << 7,
+        ADP_CNTL2_WB_ISEL = 1 << 6,
+        ADP_CNTL2_RMS_WB_OSEL = 1 << 5,
+
+        /**
+         * @brief Filter bypass bits of ADP_CNTL2
+         *
+         * ADP_FLT1_BYP/ADP_FLT2_BYP = 0 – filter is applied
+         * ADP_FLT1_BYP/ADP_FLT2_BYP = 1 – filter is bypassed
+         */
+        ADP_CNTL2_FLT2_BYP = 1 << 4,
+        ADP_CNTL2_FLT1_BYP = 1 << 3,
+
+        /**
+         * @brief Output select bit of ADP_CNTL2, see AdpOutput
+         */
+        ADP_CNTL2_RMS_OSEL = 1 << 1,
+
+        /**
+         * @brief Filter 2 type bit of ADP_CNTL2
+         *
+         * ADP_F2_HP = 0 – low-pass
+         * ADP_F2_HP = 1 – high-pass
+         */
+        ADP_CNTL2_F2_HP = 1 << 0,
+
+        /**
+         * @brief Filter 1 output scale shift (ADP_F1_OSH) bit of ADP_CNTL11
+         */
+        ADP_CNTL11_F1_OSH = 1 << 7,
+
+        /**
+         * @brief 1/A coefficient bits of ADP_CNTL3 (filter 1) and ADP_CNTL11 (filter 2)
+         */
+        ADP_F_1A = 0x7F,
+
+        /**
+         * @brief Scale shift bits of ADP_CNTL10, ADP_CNTL18 and ADP_CNTL19
+         */
+        ADP_F_SH = 0x1F,
+
+        /**
+         * @brief IIR Filter Bypass mode enable bit of ODCNTL
+         *
+         * IIR_BYPASS = 0 – IIR filter is not bypassed, i.e. filtering is applied (default)
+         * IIR_BYPASS = 1 – IIR filter is bypassed.
+         *
+         * Notes for IIR_BYPASS = 1 setting:
+         * 1. Not recommended at OSA<3:0> = 1111 (ODR = 25600Hz)
+         * 2. Not recommended in Low Power Mode with AVC<2:0> = 000 setting (no averaging)
+         * 3. This setting may reduce the resolution of the output data.
+         */
+        ODCNTL_IIR_BYPASS = 1 << 7,
+
+        /**
+         * @brief Low-Pass filter Roll-Off control bit of ODCNTL
+         *
+         * LPRO = 0 – IIR filter corner frequency set to ODR/9 (default)
+         * LPRO = 1 – IIR filter corner frequency set to ODR/2
+         */
+        ODCNTL_LPRO = 1 << 6,
+
+        /**
+         * @brief Fast Start Up Enable bit of ODCNTL
+         *
+         * The setting of this bit controls the start up time only when accelerometer operates in
+         * High-Performance mode with ODR ≤ 200Hz. If fast start up is disabled (FSTUP=0), the start
+         * up time in High-Performance mode would vary with ODR. If fast start up is enabled
+         * (FSTUP=1), the start up time in High Performance mode would be fixed. See KX134-1211
+         * Product specifications for details.
+         *
+         * FSTUP = 0 – Fast Start is disabled
+         * FSTUP = 1 – Fast Start is enabled
+         */
+        ODCNTL_FSTUP = 1 << 5,
+
+        /**
+         * @brief Output Data Rate (ODR) bits of ODCNTL
+         *
+         * The default ODR is 50Hz.
+         *
+         * OSA3|OSA2|OSA1|OSA0|Output Data Rate (Hz)
+         * :--:|:--:|:--:|:--:|:-------------------:
+         * 0   |0   |0   |0   |0.781*
+         * 0   |0   |0   |1   |1.563*
+         * 0   |0   |1   |0   |3.125*
+         * 0   |0   |1   |1   |6.25*
+         * 0   |1   |0   |0   |12.5*
+         * 0   |1   |0   |1   |25*
+         * 0   |1   |1   |0   |50*
+         * 0   |1   |1   |1   |100*
+         * 1   |0   |0   |0   |200*
+         * 1   |0   |0   |1   |400*
+         * 1   |0   |1   |0   |800**
+         * 1   |0   |1   |1   |1600**
+         * 1   |1   |0   |0   |3200**
+         * 1   |1   |0   |1   |6400**
+         * 1   |1   |1   |0   |12800**
+         * 1   |1   |1   |1   |25600**
+         *
+         * <p>* Available in Low Power and High-Performance modes</p>
+         * <p>** Available in High-Performance mode only. Accelerometer will default to
+         * High-Performance mode regardless of the RES bit setting in CNTL1 register.</p>
+         */
+        ODCNTL_OSA = 0b1111,
+
+        /**
+         * @brief Interrupt pin enable bit of INC1 (INT1) and INC5 (INT2)
+         */
+        INC_IEN = 1 << 5,
+
+        /**
+         * @brief Interrupt pin polarity bit of INC1 (INT1) and INC5 (INT2)
+         *
+         * IEA = 0 – active low
+         * IEA = 1 – active high
+         */
+        INC_IEA = 1 << 4,
+
+        /**
+         * @brief Interrupt pin response bit of INC1 (INT1) and INC5 (INT2)
+         *
+         * IEL = 0 – latched until cleared by reading INT_REL
+         * IEL = 1 – pulsed
+         */
+        INC_IEL = 1 << 3,
+
+        /**
+         * @brief Sample buffer enable bit of BUF_CNTL2
+         *
+         * BUFE = 0 – Sample buffer is disabled
+         * BUFE = 1 – Sample buffer is enabled
+         */
+        BUF_CNTL2_BUFE = 1 << 7,
+
+        /**
+         * @brief Buffer resolution bit of BUF_CNTL2
+         *
+         * BRES = 0 – Buffer stores 8-bit samples
+         * BRES = 1 – Buffer stores 16-bit samples
+         */
+        BUF_CNTL2_BRES = 1 << 6,
+
+        /**
+         * @brief Buffer full interrupt enable bit of BUF_CNTL2
+         *
+         * BFIE = 0 – Buffer full interrupt is disabled
+         * BFIE = 1 – Buffer full interrupt is enabled
+         */
+        BUF_CNTL2_BFIE = 1 << 5,
+
+        /**
+         * @brief Buffer operating mode (BM) bits of BUF_CNTL2, see BufferMode
+         */
+        BUF_CNTL2_BM = 0b11,
+
+        /**
+         * @brief Buffer trigger status bit of BUF_STATUS_2
+         *
+         * BUF_TRIG = 0 – the trigger event has not occurred
+         * BUF_TRIG = 1 – the trigger event has occurred (Trigger mode only)
+         */
+        BUF_STATUS_2_BUF_TRIG = 1 << 7
+    };
+
+    /** @brief The value of 1 LSB in gravs, indexed by Range */
+    static constexpr float GRAVS_PER_LSB[4] = { 0.00024f, 0.00049f, 0.00098f, 0.00195f };
+
+    /** @brief The first register held in the shadow cache */
+    static constexpr Register SHADOW_FIRST = Register::CNTL1;
+
+    /** @brief The last register held in the shadow cache */
+    static constexpr Register SHADOW_LAST = Register::ADP_CNTL19;
+
+    /** @brief The number of registers held in the shadow cache */
+    static constexpr size_t SHADOW_SIZE
+        = static_cast<uint8_t>(SHADOW_LAST) - static_cast<uint8_t>(SHADOW_FIRST) + 1;
+
+    /**
+     * @brief Returns the cached value of a register
+     *
+     * @param[in] addr The register to look up. Must lie in the shadow cache.
+     * @return The value the register has, or will have after the next flushRegisters()
+     */
+    uint8_t getShadowRegister(Register addr) const;
+
+    /**
+     * @brief Changes bits of a cached register, marking it dirty if its value changes
+     *
+     * @param[in] addr The register to change. Must lie in the shadow cache.
+     * @param[in] mask The bits to change
+     * @param[in] value The new value of the bits in mask
+     */
+    void setShadowBits(Register addr, uint8_t mask, uint8_t value);
+
+    /**
+     * @brief Writes all dirty registers to the KX134
+     *
+     * If any register is dirty, the KX134 is put in stand-by (PC1 = 0) once, all dirty registers
+     * are written, and CNTL1 is written last to put it in operating mode (PC1 = 1). Does nothing
+     * if no register is dirty and the KX134 is already operating.
      */
-    enum class Range : uint8_t
-    {
-        RANGE_8G = 0b00,
-        RANGE_16G = 0b01,
-        RANGE_32G = 0b10,
-        RANGE_64G = 0b11
-    };
+    void flushRegisters();
 
-public:
     /**
-     * @brief Construct a new KX134Base
+     * @brief Fills the shadow cache from the KX134 and marks all registers clean
      */
-    KX134Base();
+    void loadShadowRegisters();
+
+protected:
+    /** @brief Calibration offsets in LSB */
+    int16_t _offsets[3];
 
+private:
     /**
-     * @brief Performs a software reset
+     * @brief Returns the shadow cache index of a register
      *
-     * @return true if the reset was successful, false otherwise
+     * @param[in] addr The register. Must lie in the shadow cache.
+     * @return The index into _shadow and _shadowDirty
      */
-    bool reset();
+    static size_t shadowIndex(Register addr);
+
+    /** @brief Cached values of the registers from SHADOW_FIRST to SHADOW_LAST */
+    uint8_t _shadow[SHADOW_SIZE];
+
+    /** @brief One dirty bit per cached register */
+    uint32_t _shadowDirty[(SHADOW_SIZE + 31) / 32];
+
+    /** @brief Savings made by the shadow cache */
+    RegisterCacheStats _cacheStats;
+
+    /** @brief Bus traffic made by the driver */
+    BusStats _busStats;
+
+#if KX134_INSTRUMENTATION
+    /** @brief Detailed bus traffic and data losses. Its totals are kept in _busStats. */
+    BusProfile _profile;
+#endif
+
+    /** @brief Whether the KX134 is in operating mode (PC1 = 1) */
+    bool _operating;
 
     /**
-     * @brief Verifies the KX134 unit is connected and functioning normally
+     * @brief Returns if a cached register may be rewritten with its cached value
      *
-     * @return true if functioning normally, false otherwise. If false, call reset() and check
-     * again.
+     * Such registers may be included in a burst write to bridge a gap between dirty registers.
+     * Reserved registers and registers with side effects (e.g. BUF_CLEAR) may not.
+     *
+     * @param[in] index The shadow cache index of the register
+     * @return true if the register may be rewritten, false otherwise
      */
-    bool checkExistence();
+    static bool isBurstWritable(size_t index);
 
     /**
-     * @brief Reads the accelerations in LSB immediately
+     * @brief Decodes INS2 and INS3 into InterruptSource bits
      *
-     * @param[out] output The array to read accelerations into. output[0] is X acceleration,
-     * output[1] is Y accel, output[2] is Z accel.
+     * @param[in] ins2 The value of INS2
+     * @param[in] ins3 The value of INS3
+     * @return The pending InterruptSource bits
      */
-    void getAccelerations(int16_t* output);
+    static uint8_t decodeInterruptSources(uint8_t ins2, uint8_t ins3);
+
+    /** @brief The MCU pins listening to INT1 and INT2, or nullptr when disabled */
+    InterruptIn* _interruptPins[2];
+
+    /** @brief Flags set from the interrupt handlers */
+    EventFlags _interruptFlags;
+
+    /** @brief User function called from the interrupt handlers */
+    Callback<void(InterruptPin)> _interruptCallback;
 
     /**
-     * @brief Returns if the unit is ready to read acceleration data
+     * @brief Reads the available samples, from the buffer if enabled
      *
-     * @return true if ready, false otherwise
+     * @param[out] output The array to write samples into, as consecutive X, Y, Z triples
+     * @param[in] maxSamples The maximum number of samples to read
+     * @return The number of samples read
      */
-    bool dataReady();
+    size_t readAvailable(int16_t* output, size_t maxSamples);
 
     /**
-     * @brief Converts an LSB value to gravs
+     * @brief Anchors the sample clock for samples just read and numbers them
      *
-     * Note:
-     * +-64g: 1LSB = 0.00195g
-     * +-32g: 1LSB = 0.00098g
-     * +-16g: 1LSB = 0.00049g
-     * +-8g: 1LSB = 0.00024g
+     * @param[in] count The number of samples just read
+     * @return The index of the first of them
+     */
+    uint32_t anchorSamples(size_t count);
 
-     * @param[in] lsbValue The value in LSB to convert to gravs
-     * @return The value in gravs
+    /** @brief Time of the last interrupt on INT1 and INT2 */
+    volatile uint32_t _interruptTimeUs[2];
+
+    /** @brief Number of interrupts on INT1 and INT2 */
+    volatile uint32_t _interruptCount[2];
+
+    /** @brief Value of _interruptCount when the last interrupt anchor was taken */
+    uint32_t _anchoredInterruptCount;
+
+    /** @brief Index of the next sample to be read */
+    uint32_t _sampleIndex;
+
+    /** @brief Whether the last readBuffer() or clearBuffer() left the buffer empty */
+    bool _bufferDrained;
+
+    /**
+     * @brief MCU time the buffer level was last read, or an unbuffered sample read started. The
+     * samples read were all taken by then.
      */
-    float convertRawToGravs(int16_t lsbValue) const;
+    uint32_t _levelTimeUs;
+
+    /** @brief Value of _bufferDrained when the last samples were anchored */
+    bool _anchorDrained;
+
+    /** @brief Reconstructs the time each sample was taken */
+    KX134SampleClock _sampleClock;
+
+    /** @brief The nominal output data rate the sample clock was reset to */
+    float _sampleClockHz;
 
     /**
-     * @brief Set offsets that will be added to each acceleration reading before it is returned.
+     * @brief Checks the KX134 responds after a software reset and loads its settings
      *
-     * @param[in] offsets array of 3 integers that will be added to the results
+     * @return true if the KX134 is ready, false otherwise
      */
-    void setAccelOffsets(int16_t* offsets);
+    bool completeReset();
 
     /**
-     * @brief Set acceleration range (8, 16, 32, or 64 gs)
-     *
-     * @param[in] range The Range to set the acceleration range to
+     * @brief Completes an asynchronous init. Runs on the EventQueue passed to startInit().
      */
-    void setAccelRange(Range range);
+    void onResetTimer();
+
+    /** @brief The state of the last init or reset */
+    InitState _initState;
+
+    /** @brief MCU time the last reset was started at */
+    uint32_t _resetStartUs;
+
+    /** @brief Time the last reset took until the KX134 was ready */
+    uint32_t _timeToReadyUs;
+
+    /** @brief The EventQueue completing an asynchronous init */
+    EventQueue* _initQueue;
 
+    /** @brief The function to call when an asynchronous init completes */
+    InitCallback _onInitReady;
+};
+
+/**
+ * @brief A set of KX134 settings applied together by KX134Base::applyConfig()
+ *
+ * Settings are chained, e.g.
+ * @code
+ * accel.applyConfig(KX134Base::Config()
+ *                       .range(KX134Base::Range::RANGE_32G)
+ *                       .outputDataRateBytes(0b1101)
+ *                       .buffer(KX134Base::BufferMode::STREAM, 64));
+ * @endcode
+ */
+class KX134Base::Config
+{
+public:
     /**
-     * @brief Set Output Data Rate from Hz
-     *
-     * @param[in] hz An integer representation of the ODR in Hz
+     * @brief Construct a new, empty Config
      */
-    void setOutputDataRateHz(uint32_t hz);
+    Config();
 
     /**
-     * @brief Set Output Data Rate Bitwise
+     * @brief Sets the acceleration range
      *
-     * @param[in] byteHz A bit-wise representation of the ODR
+     * @param[in] range The Range to use
+     * @return This Config
      */
-    void setOutputDataRateBytes(uint8_t byteHz);
+    Config& range(Range range);
 
     /**
-     * @brief Initializes the KX134
+     * @brief Sets the Output Data Rate bitwise
      *
-     * @return true if the init is successful, false otherwise
+     * @param[in] byteHz A bit-wise representation of the ODR (OSA bits)
+     * @return This Config
      */
-    virtual bool init() = 0;
+    Config& outputDataRateBytes(uint8_t byteHz);
 
-protected:
     /**
-     * @brief The list of registers
+     * @brief Sets the Output Data Rate
+     *
+     * @param[in] odr The OutputDataRate to use
+     * @return This Config
      */
-    enum class Register : uint8_t
-    {
-        MAN_ID = 0x00,
-        PART_ID = 0x01,
-        XADP_L = 0x02,
-        XADP_H = 0x03,
-        YADP_L = 0x04,
-        YADP_H = 0x05,
-        ZADP_L = 0x06,
-        ZADP_H = 0x07,
-        XOUT_L = 0x08,
-        XOUT_H = 0x09,
-        YOUT_L = 0x0A,
-        YOUT_H = 0x0B,
-        ZOUT_L = 0x0C,
-        ZOUT_H = 0x0D,
-        COTR = 0x12,
-        WHO_AM_I = 0x13,
-        TSCP = 0x14,
-        TSPP = 0x15,
-        INS1 = 0x16,
-        INS2 = 0x17,
-        INS3 = 0x18,
-        STATUS_REG = 0x19,
-        INT_REL = 0x1A,
-        CNTL1 = 0x1B,
-        CNTL2 = 0x1C,
-        CNTL3 = 0x1D,
-        CNTL4 = 0x1E,
-        CNTL5 = 0x1F,
-        CNTL6 = 0x20,
-        ODCNTL = 0x21,
-        INC1 = 0x22,
-        INC2 = 0x23,
-        INC3 = 0x24,
-        INC4 = 0x25,
-        INC5 = 0x26,
-        INC6 = 0x27,
-        TILT_TIMER = 0x29,
-        TDTRC = 0x2A,
-        TDTC = 0x2B,
-        TTH = 0x2C,
-        TTL = 0x2D,
-        FTD = 0x2E,
-        STD = 0x2F,
-        TLT = 0x30,
-        TWS = 0x31,
-        FFTH = 0x32,
-        FFC = 0x33,
-        FFCNTL = 0x34,
-        TILT_ANGLE_LL = 0x37,
-        TILT_ANGLE_HL = 0x38,
-        HYST_SET = 0x39,
-        LP_CNTL1 = 0x3A,
-        LP_CNTL2 = 0x3B,
-        WUFTH = 0x49,
-        BTSWUFTH = 0x4A,
-        BTSTH = 0x4B,
-        BTSC = 0x4C,
-        WUFC = 0x4D,
-        SELF_TEST = 0x5D,
-        BUF_CNTL1 = 0x5E,
-        BUF_CNTL2 = 0x5F,
-        BUF_STATUS_1 = 0x60,
-        BUF_STATUS_2 = 0x61,
-        BUF_CLEAR = 0x62,
-        BUF_READ = 0x63,
-        ADP_CNTL1 = 0x64,
-        ADP_CNTL2 = 0x65,
-        ADP_CNTL3 = 0x66,
-        ADP_CNTL4 = 0x67,
-        ADP_CNTL5 = 0x68,
-        ADP_CNTL6 = 0x69,
-        ADP_CNTL7 = 0x6A,
-        ADP_CNTL8 = 0x6B,
-        ADP_CNTL9 = 0x6C,
-        ADP_CNTL10 = 0x6D,
-        ADP_CNTL11 = 0x6E,
-        ADP_CNTL12 = 0x6F,
-        ADP_CNTL13 = 0x70,
-        ADP_CNTL14 = 0x71,
-        ADP_CNTL15 = 0x72,
-        ADP_CNTL16 = 0x73,
-        ADP_CNTL17 = 0x74,
-        ADP_CNTL18 = 0x75,
-        ADP_CNTL19 = 0x76,
-        INTERNAL_0X7F = 0x7F
-    };
+    Config& outputDataRate(OutputDataRate odr);
 
-protected:
     /**
-     * @brief Reads a value from a low and high address and combines them to create a signed (2s
-     * complement) 16-bit integer
+     * @brief Selects High-Performance or Low Power mode (RES bit)
      *
-     * @param[in] lowAddr The low address to read from
-     * @param[in] highAddr The high address to read from
-     * @return The signed representation of their value
+     * @param[in] enable true for High-Performance mode, false for Low Power mode
+     * @return This Config
      */
-    int16_t read16BitValue(Register lowAddr, Register highAddr);
+    Config& highPerformance(bool enable);
 
     /**
-     * @brief Converts 2 8-bit unsigned integers to a single signed 16-bit (2s complement) integer
+     * @brief Enables or disables the Data Ready Engine (DRDYE bit)
      *
-     * @param[in] low The 8 lower bits
-     * @param[in] high The 8 upper bits
-     * @return The signed representation of their value
+     * @param[in] enable true to enable, false to disable
+     * @return This Config
      */
-    int16_t convertTo16BitValue(uint8_t low, uint8_t high);
+    Config& dataReadyEngine(bool enable);
 
     /**
-     * @brief Enables writing new settings to the ODCNTL and CNTL1 registers
+     * @brief Enables or disables the Tap/Double-Tap Engine (TDTE bit)
      *
-     * After writing settings, register writing is automatically disabled, and this function must be
-     * called again to enable it.
+     * @param[in] enable true to enable, false to disable
+     * @return This Config
      */
-    void enableRegisterWriting();
+    Config& tapEngine(bool enable);
 
     /**
-     * @brief Saves current settings and disables modification to ODCNTL and CNTL1 registers
+     * @brief Enables or disables the Tilt Position Engine (TPE bit)
+     *
+     * @param[in] enable true to enable, false to disable
+     * @return This Config
      */
-    void disableRegisterWriting();
+    Config& tiltEngine(bool enable);
 
     /**
-     * @brief Writes a given register 1 byte
-     * Convenience function, calls writeRegister()
+     * @brief Enables the Tap/Double-Tap Engine (TDTE bit) and sets what it reports
      *
-     * @param[in] addr The register to write to
-     * @param[in] tx_buf The data to write
-     * @param[out] rx_buf The response data to receive
+     * Disable it with tapEngine(false).
+     *
+     * @param[in] rate The TapRate the engine samples at
+     * @param[in] directions The MotionDirection bits that may report a tap (INC3)
+     * @param[in] singleTap true to report single taps (STRE)
+     * @param[in] doubleTap true to report double taps (DTRE)
+     * @return This Config
      */
-    void writeRegisterOneByte(Register addr, char tx_buf, char* rx_buf = nullptr);
+    Config& tap(TapRate rate, uint8_t directions = MOTION_ANY, bool singleTap = true,
+        bool doubleTap = true);
 
     /**
-     * @brief Reads 1 byte from a given register
-     * Convenience function, calls readRegister()
+     * @brief Sets the tap detection thresholds (TTL and TTH)
      *
-     * @param[in] addr The register to read from
-     * @param[out] rx_buf The buffer to read into
+     * A tap is detected when the jerk signal, in the units of the 8g range, lies between the
+     * thresholds. The power-on values are 26 and 203.
+     *
+     * @param[in] low The low threshold
+     * @param[in] high The high threshold
+     * @return This Config
      */
-    void readRegisterOneByte(Register addr, char& rx_buf);
+    Config& tapThreshold(uint8_t low, uint8_t high);
 
     /**
-     * @brief Reads a given register a given number of bytes
+     * @brief Sets the timing of the Tap/Double-Tap Engine
      *
-     * @param[in] addr The register to read from
-     * @param[out] rx_buf The buffer to read into
-     * @param[in] size The number of bytes to read
+     * @param[in] timing The TapTiming to use
+     * @return This Config
      */
-    virtual void readRegister(Register addr, char* rx_buf, int size = 1) = 0;
+    Config& tapTiming(const TapTiming& timing);
 
     /**
-     * @brief Writes data to a given register
+     * @brief Enables the Tilt Position Engine (TPE bit) and sets what it reports
      *
-     * @param[in] addr The register to write to
-     * @param[in] data The data to write
-     * @param[out] rx_buf The response to receive
-     * @param[in] size The number of bytes to write.
+     * Disable it with tiltEngine(false).
+     *
+     * @param[in] rate The TiltRate the engine samples at
+     * @param[in] positions The TiltPosition bits that may be reported (CNTL2)
+     * @param[in] delay The number of tilt engine samples a new position must be held for before
+     * it is reported (TILT_TIMER)
+     * @return This Config
      */
-    virtual void writeRegister(Register addr, char* data, char* rx_buf = nullptr, int size = 1) = 0;
+    Config& tilt(TiltRate rate, uint8_t positions = TILT_ANY, uint8_t delay = 1);
 
-protected:
-    /** @brief Calibration offsets in LSB */
-    int16_t _offsets[3];
+    /**
+     * @brief Sets the tilt angle limits and hysteresis
+     *
+     * See the KX134-1211 Technical Reference Manual for the encoding. The power-on values are
+     * 0x0C, 0x2A and 0x14.
+     *
+     * @param[in] low The low angle limit (TILT_ANGLE_LL)
+     * @param[in] high The high angle limit (TILT_ANGLE_HL)
+     * @param[in] hysteresis The hysteresis (HYST_SET, 6 bits)
+     * @return This Config
+     */
+    Config& tiltAngles(uint8_t low, uint8_t high, uint8_t hysteresis);
 
     /**
-     * @name CNTL1
+     * @brief Bypasses or applies the IIR filter (IIR_BYPASS bit)
      *
-     * Control register 1. Read/write control register that controls the main feature set.
+     * @param[in] bypass true to bypass the filter, false to apply it
+     * @return This Config
+     */
+    Config& iirBypass(bool bypass);
+
+    /**
+     * @brief Selects the IIR filter corner frequency (LPRO bit)
      *
-     * Note that to properly change the value of these registers, the PC1 bit in CNTL1 register must
-     * first be set to “0”.
-     * @{
+     * @param[in] halfOdr true for ODR/2, false for ODR/9
+     * @return This Config
      */
+    Config& lowPassRollOff(bool halfOdr);
 
     /**
-     * @brief The RES bit determines the performance mode
+     * @brief Enables or disables Fast Start Up (FSTUP bit)
      *
-     * RES = 0 – Low Power mode (higher noise, lower current, 16-bit output data)
-     * RES = 1 – High-Performance mode (lower noise, higher current, 16-bit output data)
+     * @param[in] enable true to enable, false to disable
+     * @return This Config
      */
-    bool res;
+    Config& fastStartUp(bool enable);
 
     /**
-     * @brief Data Ready Engine enable bit
+     * @brief Enables the sample buffer
+     *
+     * In the Trigger mode, the watermark is the number of samples kept from before the trigger
+     * event; the rest of the buffer is filled after it.
      *
-     * DRDYE = 0 – Data Ready Engine is disabled
-     * DRDYE = 1 – Data Ready Engine is enabled
+     * @param[in] mode The BufferMode to operate the buffer in
+     * @param[in] watermark The number of samples at which the watermark interrupt is raised.
+     * Clamped to the buffer capacity at the given resolution.
+     * @param[in] resolution The BufferResolution to store samples at
+     * @return This Config
      */
-    bool drdye_enable;
+    Config& buffer(BufferMode mode, uint8_t watermark,
+        BufferResolution resolution = BufferResolution::RES_16BIT);
 
     /**
-     * @brief G-range Select (GSEL) bits select the acceleration range of the accelerometer outputs
-     * per Table 7. This range is also called a full-scale range of the accelerometer.
+     * @brief Disables the sample buffer
      *
-     * GSEL1 | GSEL0 | Range
-     * ----- | ----- | -----
-     * 0     | 0     | +-8g
-     * 0     | 1     | +-16g
-     * 1     | 0     | +-32g
-     * 1     | 1     | +-64g
+     * @return This Config
      */
-    bool gsel[2];
+    Config& noBuffer();
 
     /**
-     * @brief Tap/Double-Tap Engine (TDTE) enable bit.
+     * @brief Enables or disables the buffer full interrupt (BFIE bit)
      *
-     * TDTE = 0 – Tap/Double-Tap Engine is disabled
-     * TDTE = 1 – Tap/Double-Tap Engine is enabled
+     * Must follow buffer() in the chain, which disables it. The interrupt is routed to a pin with
+     * INT_BUFFER_FULL.
+     *
+     * @param[in] enable true to enable, false to disable
+     * @return This Config
      */
-    bool tdte_enable;
+    Config& bufferFullInterrupt(bool enable);
 
     /**
-     * @brief Tilt Position Engine (TPE) enable bit.
+     * @brief Enables the wake-up function (WUFE bit)
+     *
+     * While in the sleep state, the KX134 samples at the wake-up rate, and switches to the wake
+     * state (sampling at the output data rate) once the acceleration in one of the directions
+     * exceeds the threshold for the given number of wake-up samples. The wake-up event can be
+     * routed to an interrupt pin with INT_WAKE_UP.
      *
-     * TPE = 0 – Tilt Position Engine is disabled
-     * TPE = 1 – Tilt Position Engine is enabled
+     * @param[in] rate The WakeUpRate to sample at while asleep
+     * @param[in] threshold The wake-up threshold in WUFTH counts (11 bits). See the KX134-1211
+     * Technical Reference Manual for the counts per g.
+     * @param[in] delay The number of wake-up samples the threshold must be exceeded for (WUFC)
+     * @param[in] directions The MotionDirection bits that may wake the KX134
+     * @param[in] relative true to compare with the acceleration when the count started (TH_MODE),
+     * false to compare with zero
+     * @return This Config
      */
-    bool tpe_enable;
+    Config& wakeUp(WakeUpRate rate, uint16_t threshold, uint8_t delay,
+        uint8_t directions = MOTION_ANY, bool relative = true);
 
     /**
-     * @}
+     * @brief Disables the wake-up function
+     *
+     * @return This Config
      */
+    Config& noWakeUp();
 
     /**
-     * @name ODCNTL
+     * @brief Enables the Advanced Data Path (ADPE bit)
      *
-     * Output data control register that configures the acceleration outputs.
+     * The ADP runs the accelerations through two filters and an RMS block in the KX134, and
+     * outputs the result in XADP..ZADP (see getAdpOutputs()). The filters are configured by
+     * adpFilter1() and adpFilter2(); a filter not mentioned by the Config keeps its setting.
      *
-     * Note that to properly change the value of these registers, the PC1 bit in CNTL1 register must
-     * first be set to “0”.
-     * @{
+     * @param[in] rate The rate the ADP runs at (OADP). Should not exceed the output data rate.
+     * @param[in] average The number of samples the RMS block averages
+     * @param[in] output Whether XADP..ZADP hold the filter chain or the RMS output
+     * @return This Config
      */
+    Config& advancedDataPath(OutputDataRate rate, AdpRmsAverage average,
+        AdpOutput output = AdpOutput::FILTERED);
 
     /**
-     * @brief IIR Filter Bypass mode enable bit
+     * @brief Disables the Advanced Data Path, and routes accelerations to the buffer and wake-up
+     * function again
      *
-     * IIR_BYPASS = 0 – IIR filter is not bypassed, i.e. filtering is applied (default)
-     * IIR_BYPASS = 1 – IIR filter is bypassed.
+     * @return This Config
+     */
+    Config& noAdvancedDataPath();
+
+    /**
+     * @brief Applies the first (second-order) ADP filter with the given coefficients
      *
-     * Notes for IIR_BYPASS = 1 setting:
-     * 1. Not recommended at OSA<3:0> = 1111 (ODR = 25600Hz)
-     * 2. Not recommended in Low Power Mode with AVC<2:0> = 000 setting (no averaging)
-     * 3. This setting may reduce the resolution of the output data.
+     * @param[in] coefficients The filter coefficients
+     * @return This Config
      */
-    bool iir_bypass;
+    Config& adpFilter1(const AdpFilter1Coefficients& coefficients);
 
     /**
-     * @brief Low-Pass filter Roll-Off control
+     * @brief Bypasses the first ADP filter
      *
-     * LPRO = 0 – IIR filter corner frequency set to ODR/9 (default)
-     * LPRO = 1 – IIR filter corner frequency set to ODR/2
+     * @return This Config
      */
-    bool lpro;
+    Config& noAdpFilter1();
 
     /**
-     * @brief Fast Start Up Enable bit.
+     * @brief Applies the second (first-order) ADP filter with the given coefficients
      *
-     * The setting of this bit controls the start up time only when accelerometer operates in
-     * High-Performance mode with ODR ≤ 200Hz. If fast start up is disabled (FSTUP=0), the start up
-     * time in High-Performance mode would vary with ODR. If fast start up is enabled (FSTUP=1), the
-     * start up time in High Performance mode would be fixed. See KX134-1211 Product specifications
-     * for details.
+     * @param[in] coefficients The filter coefficients
+     * @param[in] highPass true for a high-pass filter, false for a low-pass filter
+     * @return This Config
+     */
+    Config& adpFilter2(const AdpFilter2Coefficients& coefficients, bool highPass);
+
+    /**
+     * @brief Bypasses the second ADP filter
      *
-     * FSTUP = 0 – Fast Start is disabled
-     * FSTUP = 1 – Fast Start is enabled
+     * @return This Config
      */
-    bool fstup;
+    Config& noAdpFilter2();
 
     /**
-     * @brief Output Data Rate (ODR) settings for accelerometer sensor.
+     * @brief Stores the ADP outputs in the sample buffer instead of the accelerations
+     * (ADP_BUF_SEL bit)
      *
-     * The default ODR is 50Hz.
+     * The buffer then holds whatever XADP..ZADP hold, see advancedDataPath().
      *
-     * OSA3|OSA2|OSA1|OSA0|Output Data Rate (Hz)
-     * :--:|:--:|:--:|:--:|:-------------------:
-     * 0   |0   |0   |0   |0.781*
-     * 0   |0   |0   |1   |1.563*
-     * 0   |0   |1   |0   |3.125*
-     * 0   |0   |1   |1   |6.25*
-     * 0   |1   |0   |0   |12.5*
-     * 0   |1   |0   |1   |25*
-     * 0   |1   |1   |0   |50*
-     * 0   |1   |1   |1   |100*
-     * 1   |0   |0   |0   |200*
-     * 1   |0   |0   |1   |400*
-     * 1   |0   |1   |0   |800**
-     * 1   |0   |1   |1   |1600**
-     * 1   |1   |0   |0   |3200**
-     * 1   |1   |0   |1   |6400**
-     * 1   |1   |1   |0   |12800**
-     * 1   |1   |1   |1   |25600**
+     * @param[in] enable true to buffer ADP outputs, false to buffer accelerations
+     * @return This Config
+     */
+    Config& adpToBuffer(bool enable);
+
+    /**
+     * @brief Feeds the ADP outputs to the wake-up and back-to-sleep functions instead of the
+     * accelerations (ADP_WB_ISEL and RMS_WB_OSEL bits)
      *
-     * <p>* Available in Low Power and High-Performance modes</p>
-     * <p>** Available in High-Performance mode only. Accelerometer will default to High-Performance
-     * mode regardless of the RES bit setting in CNTL1 register.</p>
+     * @param[in] enable true to use ADP outputs, false to use accelerations
+     * @param[in] rms true to use the RMS output, false to use the filter chain output
+     * @return This Config
      */
-    bool osa[4];
+    Config& adpToWakeUp(bool enable, bool rms = false);
+
+private:
+    friend class KX134Base;
 
     /**
-     * @}
+     * @brief Records new values for bits of a register
+     *
+     * @param[in] addr The register to change. Must lie in the shadow cache.
+     * @param[in] mask The bits to change
+     * @param[in] value The new value of the bits in mask
+     * @return This Config
      */
+    Config& set(Register addr, uint8_t mask, uint8_t value);
 
+    /** @brief New register values, indexed like the shadow cache */
+    uint8_t _values[SHADOW_SIZE];
+
+    /** @brief The bits of each register set by this Config */
+    uint8_t _masks[SHADOW_SIZE];
 };
 
+inline int16_t KX134Base::convertTo16BitValue(uint8_t low, uint8_t high) const
+{
+    // combine low & high words
+    uint16_t val2sComplement = (static_cast<uint16_t>(high << 8)) | low;
+    return static_cast<int16_t>(val2sComplement);
+}
+
+inline uint32_t KX134Base::transactionStart()
+{
+#if KX134_INSTRUMENTATION
+    return timeUs();
+#else
+    return 0;
+#endif
+}
+
+inline void KX134Base::countTransaction(
+    Register addr, bool write, int size, uint32_t startUs, bool failed)
+{
+    ++_busStats.transactions;
+    _busStats.bytes += size + 1;
+
+#if KX134_INSTRUMENTATION
+    _profile.busTimeUs += timeUs() - startUs;
+    _profile.errors += failed;
+    ++(write ? _profile.writes : _profile.reads)[static_cast<uint8_t>(addr) & 0x7F];
+#else
+    (void)addr;
+    (void)write;
+    (void)startUs;
+    (void)failed;
+#endif
+}
+
+inline void KX134Base::unpackSamples(
+    const char* words, int16_t* output, size_t samples, bool applyOffsets) const
+{
+    const int16_t noOffsets[3] = { 0, 0, 0 };
+    const int16_t* offsets = applyOffsets ? _offsets : noOffsets;
+
+    // each value only depends on the two bytes it overwrites, so this also works in place
+    for (size_t sample = 0; sample < samples; ++sample)
+    {
+        for (size_t axis = 0; axis < 3; ++axis)
+        {
+            size_t i = sample * 3 + axis;
+            output[i] = convertTo16BitValue(words[2 * i], words[2 * i + 1]) + offsets[axis];
+        }
+    }
+}
+
+inline void KX134Base::unpackSamples8Bit(
+    const char* words, int16_t* output, size_t samples, bool applyOffsets) const
+{
+    const int16_t noOffsets[3] = { 0, 0, 0 };
+    const int16_t* offsets = applyOffsets ? _offsets : noOffsets;
+
+    // each value is twice the size of its byte, so work from the end to convert in place
+    for (size_t i = samples * 3; i-- > 0;)
+    {
+        output[i] = convertTo16BitValue(0, words[i]) + offsets[i % 3];
+    }
+}
+
 #endif // KX134_H
@@ -0,0 +1,189 @@
+#include "KX134CaptureFormat.h"
+
+#include <cmath>
+#include <cstring>
+
+/* Magic numbers, as little-endian 32-bit values */
+#define CAPTURE_HEADER_MAGIC 0x4843584BUL // "KXCH"
+#define CAPTURE_BLOCK_MAGIC 0x4443584BUL // "KXCD"
+
+constexpr uint8_t KX134CaptureFormat::VERSION;
+constexpr size_t KX134CaptureFormat::HEADER_SIZE;
+constexpr size_t KX134CaptureFormat::BLOCK_HEADER_SIZE;
+constexpr size_t KX134CaptureFormat::CRC_SIZE;
+constexpr size_t KX134CaptureFormat::MAX_SAMPLE_SIZE;
+
+/**
+ * @brief Returns the byte-wise CRC-32 lookup table, built on first use
+ *
+ * Concurrent first uses write the same values, so no locking is needed.
+ */
+static const uint32_t* crcTable()
+{
+    static uint32_t table[256];
+    static bool built = false;
+
+    if (!built)
+    {
+        for (uint32_t i = 0; i < 256; ++i)
+        {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc >> 1) ^ (crc & 1 ? 0xEDB88320UL : 0);
+            }
+            table[i] = crc;
+        }
+        built = true;
+    }
+
+    return table;
+}
+
+uint32_t KX134CaptureFormat::crc32(const uint8_t* data, size_t size, uint32_t crc)
+{
+    const uint32_t* table = crcTable();
+
+    crc = ~crc;
+    for (size_t i = 0; i < size; ++i)
+    {
+        crc = (crc >> 8) ^ table[(crc ^ data[i]) & 0xFF];
+    }
+    return ~crc;
+}
+
+void KX134CaptureFormat::encodeHeader(const Header& header, uint8_t* block)
+{
+    put32(block, CAPTURE_HEADER_MAGIC);
+    block[4] = VERSION;
+    block[5] = header.rangeG;
+    block[6] = header.outputDataRate;
+    block[7] = 0;
+    put16(block + 8, header.blockSize);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        put16(block + 10 + 2 * axis, static_cast<uint16_t>(header.offsets[axis]));
+    }
+    put32(block + 16, floatBits(header.gravsPerLsb));
+    put32(block + 20, crc32(block, 20));
+}
+
+bool KX134CaptureFormat::decodeHeader(const uint8_t* block, size_t size, Header& header)
+{
+    if (size < HEADER_SIZE || get32(block) != CAPTURE_HEADER_MAGIC || block[4] != VERSION
+        || get32(block + 20) != crc32(block, 20))
+    {
+        return false;
+    }
+
+    header.rangeG = block[5];
+    header.outputDataRate = block[6];
+    header.blockSize = get16(block + 8);
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        header.offsets[axis] = static_cast<int16_t>(get16(block + 10 + 2 * axis));
+    }
+    header.gravsPerLsb = bitsFloat(get32(block + 16));
+
+    return header.blockSize >= BLOCK_HEADER_SIZE + MAX_SAMPLE_SIZE + CRC_SIZE;
+}
+
+void KX134CaptureFormat::encodeBlockHeader(
+    uint32_t sequence, const KX134Frame& first, float periodUs, uint8_t* block)
+{
+    put32(block, CAPTURE_BLOCK_MAGIC);
+    put32(block + 4, sequence);
+    put16(block + 8, 1);
+    put16(block + 10, 0);
+    put32(block + 12, first.timestamp);
+    put32(block + 16, floatBits(periodUs));
+    put16(block + 20, static_cast<uint16_t>(first.x));
+    put16(block + 22, static_cast<uint16_t>(first.y));
+    put16(block + 24, static_cast<uint16_t>(first.z));
+}
+
+size_t KX134CaptureFormat::sealBlock(uint8_t* block, uint16_t samples, size_t size)
+{
+    put16(block + 8, samples);
+    put16(block + 10, static_cast<uint16_t>(size - BLOCK_HEADER_SIZE));
+    put32(block + size, crc32(block, size));
+    return size + CRC_SIZE;
+}
+
+int KX134CaptureFormat::decodeBlock(
+    const uint8_t* block, size_t size, uint32_t sequence, KX134Frame* output, size_t maxSamples)
+{
+    if (size < BLOCK_HEADER_SIZE + CRC_SIZE || get32(block) != CAPTURE_BLOCK_MAGIC
+        || get32(block + 4) != sequence)
+    {
+        return -1;
+    }
+
+    size_t samples = get16(block + 8);
+    size_t payloadSize = get16(block + 10);
+    size_t crcOffset = BLOCK_HEADER_SIZE + payloadSize;
+    if (samples == 0 || crcOffset + CRC_SIZE > size
+        || get32(block + crcOffset) != crc32(block, crcOffset))
+    {
+        return -1;
+    }
+
+    uint32_t firstTimestamp = get32(block + 12);
+    float periodUs = bitsFloat(get32(block + 16));
+    int16_t values[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        values[axis] = static_cast<int16_t>(get16(block + 20 + 2 * axis));
+    }
+
+    const uint8_t* payload = block + BLOCK_HEADER_SIZE;
+    const uint8_t* payloadEnd = payload + payloadSize;
+    size_t decoded = samples < maxSamples ? samples : maxSamples;
+
+    for (size_t i = 0; i < decoded; ++i)
+    {
+        if (i > 0)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                uint32_t value = 0;
+                int shift = 0;
+                uint8_t byte;
+                do
+                {
+                    if (payload == payloadEnd)
+                    {
+                        return -1;
+                    }
+                    byte = *payload++;
+                    value |= static_cast<uint32_t>(byte & 0x7F) << shift;
+                    shift += 7;
+                } while ((byte & 0x80) && shift < 21);
+
+                int32_t delta = static_cast<int32_t>(value >> 1) ^ -static_cast<int32_t>(value & 1);
+                values[axis] = static_cast<int16_t>(values[axis] + delta);
+            }
+        }
+
+        output[i] = { firstTimestamp + static_cast<uint32_t>(std::lround(i * periodUs)),
+            values[0],
+            values[1],
+            values[2] };
+    }
+
+    return static_cast<int>(samples);
+}
+
+uint32_t KX134CaptureFormat::floatBits(float value)
+{
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float KX134CaptureFormat::bitsFloat(uint32_t bits)
+{
+    float value;
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
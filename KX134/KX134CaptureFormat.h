@@ -0,0 +1,228 @@
+#ifndef KX134CAPTUREFORMAT_H
+#define KX134CAPTUREFORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include "KX134Frame.h"
+
+/**
+ * @brief Binary capture format for KX134 sample streams, and its decoder
+ *
+ * A capture is a sequence of fixed-size blocks. All fields are little-endian.
+ *
+ * The first block is the header block:
+ * | Offset | Size | Field                                       |
+ * |--------|------|---------------------------------------------|
+ * | 0      | 4    | Magic "KXCH"                                |
+ * | 4      | 1    | Format version (1)                          |
+ * | 5      | 1    | Range in g (8, 16, 32 or 64)                |
+ * | 6      | 1    | Output data rate (OSA bits of ODCNTL)       |
+ * | 7      | 1    | Reserved (0)                                |
+ * | 8      | 2    | Block size in bytes                         |
+ * | 10     | 6    | Offsets applied to the samples, X, Y, Z     |
+ * | 16     | 4    | Gravs per LSB (IEEE 754 single)             |
+ * | 20     | 4    | CRC-32 of bytes 0 to 19                     |
+ *
+ * Every following block holds consecutive samples and decodes on its own:
+ * | Offset | Size | Field                                       |
+ * |--------|------|---------------------------------------------|
+ * | 0      | 4    | Magic "KXCD"                                |
+ * | 4      | 4    | Block sequence number, from 0               |
+ * | 8      | 2    | Number of samples (at least 1)              |
+ * | 10     | 2    | Payload size in bytes                       |
+ * | 12     | 4    | Timestamp of the first sample in us         |
+ * | 16     | 4    | Sample period in us (IEEE 754 single)       |
+ * | 20     | 6    | First sample, X, Y, Z                       |
+ * | 26     | n    | Payload                                     |
+ * | 26 + n | 4    | CRC-32 of bytes 0 to 25 + n                 |
+ *
+ * The payload holds, for every sample after the first, the difference from the previous sample
+ * on X, then Y, then Z, each zigzag-encoded (so small negative differences stay small) and written
+ * as an unsigned LEB128 varint: 7 bits per byte, least significant first, the top bit set on all
+ * but the last byte. A slowly-varying axis costs 1 byte per sample instead of 2.
+ *
+ * Unused bytes up to the block size are padding. The capture ends at the first block with a bad
+ * magic number, sequence number or CRC.
+ *
+ * The CRC-32 is the IEEE 802.3 one (reflected, polynomial 0xEDB88320, as used by zlib).
+ *
+ * This file depends on the C++ standard library only, so captures can be decoded on a host.
+ */
+class KX134CaptureFormat
+{
+public:
+    /** @brief The format version written by this library */
+    static constexpr uint8_t VERSION = 1;
+
+    /** @brief The size of the header block fields */
+    static constexpr size_t HEADER_SIZE = 24;
+
+    /** @brief The size of the data block fields before the payload */
+    static constexpr size_t BLOCK_HEADER_SIZE = 26;
+
+    /** @brief The size of the CRC after the payload */
+    static constexpr size_t CRC_SIZE = 4;
+
+    /** @brief The most bytes one encoded sample can take */
+    static constexpr size_t MAX_SAMPLE_SIZE = 9;
+
+    /**
+     * @brief The capture settings stored in the header block
+     */
+    struct Header
+    {
+        /** @brief The range in g */
+        uint8_t rangeG;
+
+        /** @brief The output data rate, as the OSA bits of ODCNTL */
+        uint8_t outputDataRate;
+
+        /** @brief The block size in bytes */
+        uint16_t blockSize;
+
+        /** @brief The offsets applied to the samples */
+        int16_t offsets[3];
+
+        /** @brief The value of 1 LSB in gravs */
+        float gravsPerLsb;
+    };
+
+    /**
+     * @brief Computes the CRC-32 of data
+     *
+     * @param[in] data The data
+     * @param[in] size The number of bytes
+     * @param[in] crc The CRC of the preceding data, to compute a CRC in several parts
+     * @return The CRC
+     */
+    static uint32_t crc32(const uint8_t* data, size_t size, uint32_t crc = 0);
+
+    /**
+     * @brief Encodes a header block
+     *
+     * @param[in] header The settings to encode
+     * @param[out] block The array to write the HEADER_SIZE bytes into
+     */
+    static void encodeHeader(const Header& header, uint8_t* block);
+
+    /**
+     * @brief Decodes a header block
+     *
+     * @param[in] block The block
+     * @param[in] size The size of the block in bytes
+     * @param[out] header The decoded settings
+     * @return true if the block is a valid header block, false otherwise
+     */
+    static bool decodeHeader(const uint8_t* block, size_t size, Header& header);
+
+    /**
+     * @brief Encodes the fields of a data block before the payload, for its first sample
+     *
+     * @param[in] sequence The block sequence number
+     * @param[in] first The first sample
+     * @param[in] periodUs The sample period
+     * @param[out] block The array to write the BLOCK_HEADER_SIZE bytes into
+     */
+    static void encodeBlockHeader(
+        uint32_t sequence, const KX134Frame& first, float periodUs, uint8_t* block);
+
+    /**
+     * @brief Completes a data block once its payload is written
+     *
+     * @param[in,out] block The block
+     * @param[in] samples The number of samples in the block
+     * @param[in] size The size of the block up to the end of the payload
+     * @return The size of the block including the CRC
+     */
+    static size_t sealBlock(uint8_t* block, uint16_t samples, size_t size);
+
+    /**
+     * @brief Decodes a data block
+     *
+     * @param[in] block The block
+     * @param[in] size The size of the block in bytes
+     * @param[in] sequence The expected block sequence number
+     * @param[out] output The array to write the samples into
+     * @param[in] maxSamples The size of output. Samples that do not fit are not decoded.
+     * @return The number of samples in the block, or -1 if it is not a valid data block
+     */
+    static int decodeBlock(const uint8_t* block, size_t size, uint32_t sequence, KX134Frame* output,
+        size_t maxSamples);
+
+    /**
+     * @brief Writes a value as an unsigned LEB128 varint
+     *
+     * @param[in] value The value
+     * @param[out] output The array to write into
+     * @return The number of bytes written, 1 to 3
+     */
+    static size_t putVarint(uint32_t value, uint8_t* output)
+    {
+        size_t size = 0;
+        while (value >= 0x80)
+        {
+            output[size++] = static_cast<uint8_t>(value) | 0x80;
+            value >>= 7;
+        }
+        output[size++] = static_cast<uint8_t>(value);
+        return size;
+    }
+
+    /**
+     * @brief Maps a signed difference to an unsigned value, interleaving positive and negative
+     *
+     * @param[in] value The difference
+     * @return 0 for 0, 1 for -1, 2 for 1, 3 for -2...
+     */
+    static uint32_t zigzag(int32_t value)
+    {
+        return (static_cast<uint32_t>(value) << 1) ^ static_cast<uint32_t>(value >> 31);
+    }
+
+    /**
+     * @brief Writes a little-endian 16-bit value
+     */
+    static void put16(uint8_t* output, uint16_t value)
+    {
+        output[0] = static_cast<uint8_t>(value);
+        output[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    /**
+     * @brief Writes a little-endian 32-bit value
+     */
+    static void put32(uint8_t* output, uint32_t value)
+    {
+        put16(output, static_cast<uint16_t>(value));
+        put16(output + 2, static_cast<uint16_t>(value >> 16));
+    }
+
+    /**
+     * @brief Reads a little-endian 16-bit value
+     */
+    static uint16_t get16(const uint8_t* input)
+    {
+        return static_cast<uint16_t>(input[0] | (input[1] << 8));
+    }
+
+    /**
+     * @brief Reads a little-endian 32-bit value
+     */
+    static uint32_t get32(const uint8_t* input)
+    {
+        return get16(input) | (static_cast<uint32_t>(get16(input + 2)) << 16);
+    }
+
+    /**
+     * @brief Returns the bit pattern of a float
+     */
+    static uint32_t floatBits(float value);
+
+    /**
+     * @brief Returns the float with a bit pattern
+     */
+    static float bitsFloat(uint32_t bits);
+};
+
+#endif
@@ -0,0 +1,162 @@
+#include "KX134CaptureWriter.h"
+
+#include <cmath>
+
+constexpr size_t KX134CaptureWriter::BLOCK_SIZE;
+
+KX134CaptureWriter::KX134CaptureWriter(BlockDevice& device, bd_addr_t start)
+    : _device(device)
+    , _start(start)
+    , _address(start)
+    , _erasedEnd(start)
+    , _blockSize(0)
+    , _blockSamples(0)
+    , _sequence(0)
+    , _previous {}
+    , _blockTimestamp(0)
+    , _blockPeriodUs(0.0f)
+    , _samplesWritten(0)
+{
+}
+
+int KX134CaptureWriter::begin(const KX134CaptureFormat::Header& header)
+{
+    if (BLOCK_SIZE % _device.get_program_size() != 0 || _start % _device.get_erase_size() != 0)
+    {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    _address = _start;
+    _erasedEnd = _start;
+
+    KX134CaptureFormat::Header fullHeader = header;
+    fullHeader.blockSize = BLOCK_SIZE;
+
+    memset(_block, 0, sizeof(_block));
+    KX134CaptureFormat::encodeHeader(fullHeader, _block);
+    _blockSize = KX134CaptureFormat::HEADER_SIZE;
+    _blockSamples = 0;
+    _sequence = 0;
+    _samplesWritten = 0;
+
+    return programBlock();
+}
+
+int KX134CaptureWriter::write(const KX134Frame* frames, size_t count, float periodUs)
+{
+    for (size_t i = 0; i < count; ++i)
+    {
+        const KX134Frame& frame = frames[i];
+
+        if (_blockSamples != 0)
+        {
+            // the decoder spaces samples evenly from the first one of the block
+            uint32_t expected = _blockTimestamp
+                + static_cast<uint32_t>(std::lround(_blockSamples * _blockPeriodUs));
+            int32_t error = static_cast<int32_t>(frame.timestamp - expected);
+            bool onTime = error >= -1 && error <= 1 && periodUs == _blockPeriodUs;
+
+            bool fits = _blockSize + KX134CaptureFormat::MAX_SAMPLE_SIZE
+                    + KX134CaptureFormat::CRC_SIZE
+                <= BLOCK_SIZE;
+
+            if (onTime && fits && _blockSamples != UINT16_MAX)
+            {
+                const int16_t values[3] = { frame.x, frame.y, frame.z };
+                const int16_t previous[3] = { _previous.x, _previous.y, _previous.z };
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    _blockSize += KX134CaptureFormat::putVarint(
+                        KX134CaptureFormat::zigzag(values[axis] - previous[axis]),
+                        _block + _blockSize);
+                }
+
+                _previous = frame;
+                ++_blockSamples;
+                ++_samplesWritten;
+                continue;
+            }
+
+            int result = programBlock();
+            if (result != BD_ERROR_OK)
+            {
+                return result;
+            }
+        }
+
+        startBlock(frame, periodUs);
+    }
+
+    return BD_ERROR_OK;
+}
+
+int KX134CaptureWriter::flush()
+{
+    if (_blockSamples != 0)
+    {
+        int result = programBlock();
+        if (result != BD_ERROR_OK)
+        {
+            return result;
+        }
+    }
+
+    return _device.sync();
+}
+
+bd_size_t KX134CaptureWriter::bytesWritten() const { return _address - _start; }
+
+uint32_t KX134CaptureWriter::samplesWritten() const { return _samplesWritten; }
+
+int KX134CaptureWriter::programBlock()
+{
+    if (_blockSamples != 0)
+    {
+        _blockSize = KX134CaptureFormat::sealBlock(_block, _blockSamples, _blockSize);
+    }
+
+    if (_address + BLOCK_SIZE > _device.size())
+    {
+        return BD_ERROR_DEVICE_ERROR;
+    }
+
+    while (_erasedEnd < _address + BLOCK_SIZE)
+    {
+        int result = _device.erase(_erasedEnd, _device.get_erase_size());
+        if (result != BD_ERROR_OK)
+        {
+            return result;
+        }
+        _erasedEnd += _device.get_erase_size();
+    }
+
+    memset(_block + _blockSize, 0, BLOCK_SIZE - _blockSize);
+    int result = _device.program(_block, _address, BLOCK_SIZE);
+    if (result != BD_ERROR_OK)
+    {
+        return result;
+    }
+
+    // the header block is not numbered
+    if (_blockSamples != 0)
+    {
+        ++_sequence;
+    }
+    _address += BLOCK_SIZE;
+    _blockSize = 0;
+    _blockSamples = 0;
+
+    return BD_ERROR_OK;
+}
+
+void KX134CaptureWriter::startBlock(const KX134Frame& frame, float periodUs)
+{
+    KX134CaptureFormat::encodeBlockHeader(_sequence, frame, periodUs, _block);
+
+    _blockSize = KX134CaptureFormat::BLOCK_HEADER_SIZE;
+    _blockSamples = 1;
+    _blockTimestamp = frame.timestamp;
+    _blockPeriodUs = periodUs;
+    _previous = frame;
+    ++_samplesWritten;
+}
@@ -0,0 +1,128 @@
+#ifndef KX134CAPTUREWRITER_H
+#define KX134CAPTUREWRITER_H
+
+#include "mbed.h"
+#include "BlockDevice.h"
+#include "KX134CaptureFormat.h"
+
+/**
+ * @brief Streams KX134 samples to a BlockDevice in the KX134CaptureFormat
+ *
+ * Samples are encoded into a RAM block as they arrive, and each block is programmed once full,
+ * erasing the device ahead of it as needed. One block of samples is lost at most on power failure.
+ *
+ * Frames within a block are assumed to be evenly spaced by the period given to write(). A frame
+ * whose timestamp differs from that by more than 1us starts a new block, so the decoded timestamps
+ * match the written ones.
+ */
+class KX134CaptureWriter
+{
+public:
+    /** @brief The size of each block in bytes */
+    static constexpr size_t BLOCK_SIZE = 512;
+
+    /**
+     * @brief Construct a new KX134CaptureWriter
+     *
+     * @param[in] device The initialized block device to write to
+     * @param[in] start The address to write the capture at. Must be a multiple of the device's
+     * erase size.
+     */
+    KX134CaptureWriter(BlockDevice& device, bd_addr_t start = 0);
+
+    /**
+     * @brief Starts a capture by writing its header block
+     *
+     * @param[in] header The capture settings. The block size is filled in.
+     * @return BD_ERROR_OK on success, or a BlockDevice error code
+     */
+    int begin(const KX134CaptureFormat::Header& header);
+
+    /**
+     * @brief Appends samples to the capture
+     *
+     * @param[in] frames The samples, e.g. from KX134Base::readFrames()
+     * @param[in] count The number of samples
+     * @param[in] periodUs The sample period, e.g. from KX134Base::getSampleClock()
+     * @return BD_ERROR_OK on success, or a BlockDevice error code. BD_ERROR_DEVICE_ERROR when the
+     * device is full.
+     */
+    int write(const KX134Frame* frames, size_t count, float periodUs);
+
+    /**
+     * @brief Writes the samples held in RAM, padding the last block
+     *
+     * Later samples start a new block.
+     *
+     * @return BD_ERROR_OK on success, or a BlockDevice error code
+     */
+    int flush();
+
+    /**
+     * @brief Returns the number of bytes programmed so far, including the header block
+     *
+     * @return The capture size in bytes
+     */
+    bd_size_t bytesWritten() const;
+
+    /**
+     * @brief Returns the number of samples written so far, including those held in RAM
+     *
+     * @return The number of samples
+     */
+    uint32_t samplesWritten() const;
+
+private:
+    /**
+     * @brief Completes the block in RAM and programs it
+     *
+     * @return BD_ERROR_OK on success, or a BlockDevice error code
+     */
+    int programBlock();
+
+    /**
+     * @brief Starts a new block in RAM with a first sample
+     *
+     * @param[in] frame The first sample
+     * @param[in] periodUs The sample period
+     */
+    void startBlock(const KX134Frame& frame, float periodUs);
+
+    /** @brief The device to write to */
+    BlockDevice& _device;
+
+    /** @brief The address of the capture */
+    bd_addr_t _start;
+
+    /** @brief The address of the next block */
+    bd_addr_t _address;
+
+    /** @brief The end of the erased area */
+    bd_addr_t _erasedEnd;
+
+    /** @brief The block being filled */
+    uint8_t _block[BLOCK_SIZE];
+
+    /** @brief Bytes used in _block */
+    size_t _blockSize;
+
+    /** @brief Samples in _block */
+    uint16_t _blockSamples;
+
+    /** @brief Sequence number of the block being filled */
+    uint32_t _sequence;
+
+    /** @brief The last sample added to _block */
+    KX134Frame _previous;
+
+    /** @brief The timestamp of the first sample in _block */
+    uint32_t _blockTimestamp;
+
+    /** @brief The sample period of _block */
+    float _blockPeriodUs;
+
+    /** @brief The number of samples written */
+    uint32_t _samplesWritten;
+};
+
+#endif
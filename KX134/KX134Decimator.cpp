@@ -0,0 +1,263 @@
+#include "KX134Decimator.h"
+
+#include <cmath>
+
+/**
+ * @brief Saturates a value to the int16_t range
+ */
+static inline int16_t saturate16(int32_t value)
+{
+    return static_cast<int16_t>(value > INT16_MAX ? INT16_MAX : (value < INT16_MIN ? INT16_MIN : value));
+}
+
+/**
+ * @brief Designs a windowed-sinc (Hamming) low-pass filter with a DC gain of 1
+ */
+static void designLowPassF32(float* coefficients, size_t taps, size_t factor)
+{
+    const float pi = 3.14159265f;
+    float cutoff = 0.8f * 0.5f / factor; // cycles per input sample
+    float center = (taps - 1) / 2.0f;
+    float sum = 0.0f;
+
+    for (size_t i = 0; i < taps; ++i)
+    {
+        float t = i - center;
+        float sinc = t == 0.0f ? 2.0f * cutoff : std::sin(2.0f * pi * cutoff * t) / (pi * t);
+        float window = taps > 1 ? 0.54f - 0.46f * std::cos(2.0f * pi * i / (taps - 1)) : 1.0f;
+        coefficients[i] = sinc * window;
+        sum += coefficients[i];
+    }
+
+    for (size_t i = 0; i < taps; ++i)
+    {
+        coefficients[i] /= sum;
+    }
+}
+
+/**
+ * @brief Dot product of float coefficients and history
+ */
+static inline float dot(const float* coefficients, const float* history, size_t taps)
+{
+    float acc = 0.0f;
+    for (size_t i = 0; i < taps; ++i)
+    {
+        acc += coefficients[i] * history[i];
+    }
+    return acc;
+}
+
+/**
+ * @brief Dot product of Q15 coefficients and history, rounded back to the history's scale
+ */
+static inline int16_t dot(const int16_t* coefficients, const int16_t* history, size_t taps)
+{
+    int64_t acc = 0;
+    for (size_t i = 0; i < taps; ++i)
+    {
+        acc += static_cast<int32_t>(coefficients[i]) * history[i];
+    }
+    return saturate16(static_cast<int32_t>((acc + (1 << 14)) >> 15));
+}
+
+template <typename T> constexpr size_t KX134FirDecimator<T>::MAX_TAPS;
+
+template <typename T>
+KX134FirDecimator<T>::KX134FirDecimator(const T* coefficients, size_t taps, size_t factor)
+    : _taps(taps > MAX_TAPS ? MAX_TAPS : (taps == 0 ? 1 : taps))
+    , _factor(factor == 0 ? 1 : factor)
+{
+    for (size_t i = 0; i < _taps; ++i)
+    {
+        _coefficients[i] = taps != 0 ? coefficients[i] : T();
+    }
+
+    reset();
+}
+
+template <> void KX134FirDecimator<float>::designLowPass(float* coefficients, size_t taps, size_t factor)
+{
+    designLowPassF32(coefficients, taps, factor);
+}
+
+template <>
+void KX134FirDecimator<int16_t>::designLowPass(int16_t* coefficients, size_t taps, size_t factor)
+{
+    float design[MAX_TAPS];
+    if (taps > MAX_TAPS)
+    {
+        taps = MAX_TAPS;
+    }
+
+    designLowPassF32(design, taps, factor);
+    for (size_t i = 0; i < taps; ++i)
+    {
+        coefficients[i] = saturate16(static_cast<int32_t>(std::lround(design[i] * 32768.0f)));
+    }
+}
+
+template <typename T> size_t KX134FirDecimator<T>::process(const int16_t* input, size_t samples, T* output)
+{
+    size_t outputs = 0;
+
+    for (size_t sample = 0; sample < samples; ++sample, input += 3)
+    {
+        _position = (_position == 0 ? _taps : _position) - 1;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            _history[axis][_position] = _history[axis][_position + _taps] = input[axis];
+        }
+
+        if (--_phase != 0)
+        {
+            continue;
+        }
+        _phase = _factor;
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            *output++ = dot(_coefficients, &_history[axis][_position], _taps);
+        }
+        ++outputs;
+    }
+
+    return outputs;
+}
+
+template <typename T> void KX134FirDecimator<T>::reset()
+{
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        for (size_t i = 0; i < 2 * MAX_TAPS; ++i)
+        {
+            _history[axis][i] = T();
+        }
+    }
+
+    _position = 0;
+    _phase = _factor;
+}
+
+template class KX134FirDecimator<float>;
+template class KX134FirDecimator<int16_t>;
+
+constexpr size_t KX134CicDecimator::MAX_STAGES;
+constexpr uint32_t KX134CicDecimator::MAX_GAIN;
+
+bool KX134CicDecimator::isSupported(size_t factor, size_t stages)
+{
+    if (factor == 0 || factor > MAX_GAIN || stages == 0 || stages > MAX_STAGES)
+    {
+        return false;
+    }
+
+    uint64_t gain = 1;
+    for (size_t i = 0; i < stages; ++i)
+    {
+        gain *= factor;
+    }
+
+    return gain <= MAX_GAIN;
+}
+
+KX134CicDecimator::KX134CicDecimator(size_t factor, size_t stages, bool compensate)
+    : _factor(factor == 0 ? 1 : factor)
+    , _stages(stages == 0 ? 1 : (stages > MAX_STAGES ? MAX_STAGES : stages))
+    , _compensate(compensate)
+    , _gain(1)
+{
+    // otherwise, the integrators wrap by more than the combs can cancel
+    MBED_ASSERT(isSupported(_factor, _stages));
+
+    while (_stages > 1 && !isSupported(_factor, _stages))
+    {
+        --_stages;
+    }
+    if (_factor > MAX_GAIN)
+    {
+        _factor = MAX_GAIN;
+    }
+
+    for (size_t i = 0; i < _stages; ++i)
+    {
+        _gain *= _factor;
+    }
+
+    reset();
+}
+
+size_t KX134CicDecimator::getStages() const { return _stages; }
+
+size_t KX134CicDecimator::process(const int16_t* input, size_t samples, int16_t* output)
+{
+    size_t outputs = 0;
+
+    for (size_t sample = 0; sample < samples; ++sample, input += 3)
+    {
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            uint32_t value = static_cast<uint32_t>(static_cast<int32_t>(input[axis]));
+            for (size_t stage = 0; stage < _stages; ++stage)
+            {
+                value = _integrators[axis][stage] += value;
+            }
+        }
+
+        if (--_phase != 0)
+        {
+            continue;
+        }
+        _phase = _factor;
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            uint32_t value = _integrators[axis][_stages - 1];
+            for (size_t stage = 0; stage < _stages; ++stage)
+            {
+                uint32_t delayed = _combs[axis][stage];
+                _combs[axis][stage] = value;
+                value -= delayed;
+            }
+
+            // round to nearest while removing the CIC gain. At MAX_GAIN, the rounded value may
+            // need a 33rd bit.
+            int64_t sum = static_cast<int32_t>(value);
+            int32_t cic = static_cast<int32_t>((sum + (sum >= 0 ? _gain / 2 : -_gain / 2)) / _gain);
+
+            if (!_compensate)
+            {
+                *output++ = saturate16(cic);
+                continue;
+            }
+
+            // 3-tap compensator [-a, 1 + 2a, -a] with a = stages / 24, flattening the
+            // sinc^stages droop to second order
+            int32_t* previous = _previous[axis];
+            int32_t boost = 2 * previous[0] - cic - previous[1];
+            int32_t compensated = previous[0] + (boost * static_cast<int32_t>(_stages)) / 24;
+            previous[1] = previous[0];
+            previous[0] = cic;
+
+            *output++ = saturate16(compensated);
+        }
+        ++outputs;
+    }
+
+    return outputs;
+}
+
+void KX134CicDecimator::reset()
+{
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        for (size_t stage = 0; stage < MAX_STAGES; ++stage)
+        {
+            _integrators[axis][stage] = 0;
+            _combs[axis][stage] = 0;
+        }
+        _previous[axis][0] = _previous[axis][1] = 0;
+    }
+
+    _phase = _factor;
+}
@@ -0,0 +1,186 @@
+#ifndef KX134DECIMATOR_H
+#define KX134DECIMATOR_H
+
+#include "mbed.h"
+
+/**
+ * @brief Low-pass FIR filter and decimator for blocks of KX134 samples
+ *
+ * Consumes samples in LSB as consecutive X, Y, Z triples, e.g. blocks returned by readBuffer(),
+ * and emits one filtered sample per factor input samples. Only the retained outputs are computed,
+ * so the cost per output sample is one dot product over the taps, as with a polyphase
+ * decomposition.
+ *
+ * Each axis keeps its history twice in a row, so every dot product runs over contiguous memory
+ * and can be unrolled or vectorized by the compiler.
+ *
+ * Instantiated for float (KX134FirDecimatorF32) and Q15 fixed-point (KX134FirDecimatorQ15)
+ * coefficients and outputs. Q15 outputs are in LSB, saturated to the int16_t range.
+ *
+ * @tparam T The coefficient and output type, float or int16_t
+ */
+template <typename T> class KX134FirDecimator
+{
+public:
+    /** @brief The most taps a filter may have */
+    static constexpr size_t MAX_TAPS = 64;
+
+    /**
+     * @brief Construct a new KX134FirDecimator
+     *
+     * @param[in] coefficients The filter coefficients, copied. In Q15 format for int16_t.
+     * @param[in] taps The number of coefficients, clamped to MAX_TAPS
+     * @param[in] factor The decimation factor. 1 filters without decimating.
+     */
+    KX134FirDecimator(const T* coefficients, size_t taps, size_t factor);
+
+    /**
+     * @brief Designs a windowed-sinc (Hamming) low-pass filter suitable for decimation
+     *
+     * The cutoff is 80% of the output Nyquist frequency, leaving the rest for the transition band.
+     * The DC gain is 1.
+     *
+     * @param[out] coefficients The array to write the coefficients into
+     * @param[in] taps The number of coefficients
+     * @param[in] factor The decimation factor the filter will be used with
+     */
+    static void designLowPass(T* coefficients, size_t taps, size_t factor);
+
+    /**
+     * @brief Filters and decimates samples
+     *
+     * @param[in] input The samples in LSB, as consecutive X, Y, Z triples
+     * @param[in] samples The number of input samples
+     * @param[out] output The array to write the output samples into, as consecutive X, Y, Z
+     * triples. Must hold samples / factor + 1 samples.
+     * @return The number of output samples written
+     */
+    size_t process(const int16_t* input, size_t samples, T* output);
+
+    /**
+     * @brief Clears the filter history
+     */
+    void reset();
+
+private:
+    /** @brief The coefficients */
+    T _coefficients[MAX_TAPS];
+
+    /** @brief The number of coefficients */
+    size_t _taps;
+
+    /** @brief The decimation factor */
+    size_t _factor;
+
+    /** @brief Per-axis history, newest first from _position, stored twice */
+    T _history[3][2 * MAX_TAPS];
+
+    /** @brief Index of the newest sample in _history */
+    size_t _position;
+
+    /** @brief Number of input samples until the next output */
+    size_t _phase;
+};
+
+typedef KX134FirDecimator<float> KX134FirDecimatorF32;
+typedef KX134FirDecimator<int16_t> KX134FirDecimatorQ15;
+
+/**
+ * @brief CIC decimator with droop compensation for blocks of KX134 samples
+ *
+ * A cascaded integrator-comb decimator needs no multiplications and little memory, which suits
+ * large decimation factors. Its passband droops like sinc^stages, which a 3-tap FIR compensator at
+ * the output rate more than halves below about a fifth of the output rate.
+ * Alias rejection is weaker than a long FIR's; follow it with a KX134FirDecimator for a sharper
+ * cut-off.
+ *
+ * Integer arithmetic only. Outputs are in LSB, with a DC gain of 1.
+ */
+class KX134CicDecimator
+{
+public:
+    /** @brief The most integrator/comb stages */
+    static constexpr size_t MAX_STAGES = 4;
+
+    /**
+     * @brief The largest CIC gain, factor ^ stages. The register growth it stands for, 16 bits,
+     * fits the 32-bit integrators on top of 16-bit samples.
+     */
+    static constexpr uint32_t MAX_GAIN = 1 << 16;
+
+    /**
+     * @brief Returns if a factor and stage count fit the integrators without overflowing
+     *
+     * That is, if factor ^ stages is at most MAX_GAIN, e.g. 4 stages up to a factor of 16 or 3
+     * stages up to a factor of 40.
+     *
+     * @param[in] factor The decimation factor
+     * @param[in] stages The number of integrator and comb stages
+     * @return true if supported, false otherwise
+     */
+    static bool isSupported(size_t factor, size_t stages);
+
+    /**
+     * @brief Construct a new KX134CicDecimator
+     *
+     * The factor and stages must be supported, see isSupported(). Otherwise, this asserts, or
+     * with assertions disabled, drops stages (and clamps the factor to MAX_GAIN) until they are.
+     *
+     * @param[in] factor The decimation factor, at most MAX_GAIN
+     * @param[in] stages The number of integrator and comb stages, clamped to 1..MAX_STAGES
+     * @param[in] compensate Whether to apply the droop compensator
+     */
+    KX134CicDecimator(size_t factor, size_t stages = 3, bool compensate = true);
+
+    /**
+     * @brief Returns the number of integrator and comb stages in use
+     *
+     * @return The number of stages
+     */
+    size_t getStages() const;
+
+    /**
+     * @brief Decimates samples
+     *
+     * The compensator delays the output by one output sample.
+     *
+     * @param[in] input The samples in LSB, as consecutive X, Y, Z triples
+     * @param[in] samples The number of input samples
+     * @param[out] output The array to write the output samples into, as consecutive X, Y, Z
+     * triples. Must hold samples / factor + 1 samples.
+     * @return The number of output samples written
+     */
+    size_t process(const int16_t* input, size_t samples, int16_t* output);
+
+    /**
+     * @brief Clears the integrators, combs and compensator
+     */
+    void reset();
+
+private:
+    /** @brief The decimation factor */
+    size_t _factor;
+
+    /** @brief The number of stages */
+    size_t _stages;
+
+    /** @brief Whether the droop compensator is applied */
+    bool _compensate;
+
+    /** @brief The DC gain of the CIC, factor ^ stages */
+    int32_t _gain;
+
+    /** @brief Integrator states. Wrap-around is expected and cancelled by the combs. */
+    uint32_t _integrators[3][MAX_STAGES];
+
+    /** @brief Comb delay lines */
+    uint32_t _combs[3][MAX_STAGES];
+
+    /** @brief The last two CIC outputs, for the compensator */
+    int32_t _previous[3][2];
+
+    /** @brief Number of input samples until the next output */
+    size_t _phase;
+};
+
+#endif
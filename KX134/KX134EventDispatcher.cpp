@@ -0,0 +1,79 @@
+#include "KX134EventDispatcher.h"
+
+KX134EventDispatcher::KX134EventDispatcher(KX134Base& accel, EventQueue& queue)
+    : _accel(accel)
+    , _queue(queue)
+    , _pin(KX134Base::InterruptPin::INT1)
+    , _started(false)
+    , _eventCount(0)
+{
+}
+
+void KX134EventDispatcher::onTap(TapCallback onTap) { _onTap = onTap; }
+
+void KX134EventDispatcher::onTilt(TiltCallback onTilt) { _onTilt = onTilt; }
+
+void KX134EventDispatcher::onWakeUp(WakeUpCallback onWakeUp) { _onWakeUp = onWakeUp; }
+
+void KX134EventDispatcher::start(KX134Base::InterruptPin pin, PinName mcuPin, uint8_t sources)
+{
+    stop();
+
+    _pin = pin;
+    _accel.attachInterruptCallback(callback(this, &KX134EventDispatcher::onInterrupt));
+    _accel.enableInterrupt(pin, mcuPin, sources);
+
+    // discard events from before the start
+    _accel.readEvents();
+    _started = true;
+}
+
+void KX134EventDispatcher::stop()
+{
+    if (!_started)
+    {
+        return;
+    }
+
+    _started = false;
+    _accel.disableInterrupt(_pin);
+    _accel.attachInterruptCallback(nullptr);
+}
+
+uint32_t KX134EventDispatcher::eventCount() const { return _eventCount; }
+
+void KX134EventDispatcher::onInterrupt(KX134Base::InterruptPin pin)
+{
+    (void)pin;
+
+    _queue.call(this, &KX134EventDispatcher::process);
+}
+
+void KX134EventDispatcher::process()
+{
+    if (!_started)
+    {
+        return;
+    }
+
+    KX134Base::Events events = _accel.readEvents();
+
+    if ((events.sources & KX134Base::INT_TAP) && events.tap != KX134Base::TapType::NONE
+        && _onTap)
+    {
+        _onTap(events.tap, events.tapDirection);
+        ++_eventCount;
+    }
+
+    if ((events.sources & KX134Base::INT_TILT) && _onTilt)
+    {
+        _onTilt(events.tiltPosition, events.previousTiltPosition);
+        ++_eventCount;
+    }
+
+    if ((events.sources & KX134Base::INT_WAKE_UP) && _onWakeUp)
+    {
+        _onWakeUp(events.wakeUpDirection);
+        ++_eventCount;
+    }
+}
@@ -0,0 +1,139 @@
+#ifndef KX134EVENTDISPATCHER_H
+#define KX134EVENTDISPATCHER_H
+
+#include "mbed.h"
+#include "KX134Base.h"
+
+/**
+ * @brief Delivers the KX134's on-chip engine events (tap, tilt, wake-up) to an EventQueue
+ *
+ * The engines run in the KX134 and only interrupt the MCU when they detect an event. The
+ * interrupt handler posts an event to the queue, which reads and releases the interrupt status
+ * in one transaction (see KX134Base::readEvents()) and calls the attached functions.
+ *
+ * The engines are configured separately, e.g.
+ * @code
+ * accel.applyConfig(KX134Base::Config()
+ *                       .tap(KX134Base::TapRate::TAP_400HZ)
+ *                       .tilt(KX134Base::TiltRate::TILT_12_5HZ));
+ * dispatcher.onTap(callback(&handleTap));
+ * dispatcher.start(KX134Base::InterruptPin::INT1, PIN_KX134_INT1,
+ *     KX134Base::INT_TAP | KX134Base::INT_TILT);
+ * @endcode
+ *
+ * It takes over the KX134's interrupt callback (see KX134Base::attachInterruptCallback()) while
+ * started.
+ */
+class KX134EventDispatcher
+{
+public:
+    /**
+     * @brief Function receiving tap events. Called on the EventQueue.
+     *
+     * Receives the kind of tap and its MotionDirection.
+     */
+    typedef Callback<void(KX134Base::TapType, uint8_t)> TapCallback;
+
+    /**
+     * @brief Function receiving tilt events. Called on the EventQueue.
+     *
+     * Receives the current and previous TiltPosition.
+     */
+    typedef Callback<void(uint8_t, uint8_t)> TiltCallback;
+
+    /**
+     * @brief Function receiving wake-up events. Called on the EventQueue.
+     *
+     * Receives the MotionDirection bits that caused the wake-up.
+     */
+    typedef Callback<void(uint8_t)> WakeUpCallback;
+
+    /**
+     * @brief Construct a new KX134EventDispatcher
+     *
+     * @param[in] accel The initialized KX134
+     * @param[in] queue The EventQueue to deliver events on
+     */
+    KX134EventDispatcher(KX134Base& accel, EventQueue& queue);
+
+    /**
+     * @brief Attaches the function receiving tap events
+     *
+     * @param[in] onTap The function to call, or nullptr to detach
+     */
+    void onTap(TapCallback onTap);
+
+    /**
+     * @brief Attaches the function receiving tilt events
+     *
+     * @param[in] onTilt The function to call, or nullptr to detach
+     */
+    void onTilt(TiltCallback onTilt);
+
+    /**
+     * @brief Attaches the function receiving wake-up events
+     *
+     * @param[in] onWakeUp The function to call, or nullptr to detach
+     */
+    void onWakeUp(WakeUpCallback onWakeUp);
+
+    /**
+     * @brief Routes engine interrupts to a pin and starts delivering events
+     *
+     * @param[in] pin The KX134 interrupt pin to use
+     * @param[in] mcuPin The MCU pin the KX134 interrupt pin is connected to
+     * @param[in] sources The InterruptSource bits to deliver, e.g. INT_TAP | INT_TILT
+     */
+    void start(KX134Base::InterruptPin pin, PinName mcuPin, uint8_t sources);
+
+    /**
+     * @brief Stops delivering events and disables the interrupt pin
+     */
+    void stop();
+
+    /**
+     * @brief Returns the number of events delivered
+     *
+     * @return The number of callbacks made since construction
+     */
+    uint32_t eventCount() const;
+
+private:
+    /**
+     * @brief Interrupt callback, posts process() to the EventQueue
+     *
+     * @param[in] pin The KX134 interrupt pin that fired
+     */
+    void onInterrupt(KX134Base::InterruptPin pin);
+
+    /**
+     * @brief Reads the pending events and delivers them. Runs on the EventQueue.
+     */
+    void process();
+
+    /** @brief The KX134 */
+    KX134Base& _accel;
+
+    /** @brief The EventQueue events are delivered on */
+    EventQueue& _queue;
+
+    /** @brief The interrupt pin in use */
+    KX134Base::InterruptPin _pin;
+
+    /** @brief Whether events are being delivered */
+    volatile bool _started;
+
+    /** @brief The function receiving tap events */
+    TapCallback _onTap;
+
+    /** @brief The function receiving tilt events */
+    TiltCallback _onTilt;
+
+    /** @brief The function receiving wake-up events */
+    WakeUpCallback _onWakeUp;
+
+    /** @brief The number of events delivered */
+    uint32_t _eventCount;
+};
+
+#endif
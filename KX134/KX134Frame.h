@@ -0,0 +1,24 @@
+#ifndef KX134FRAME_H
+#define KX134FRAME_H
+
+#include <cstdint>
+
+/**
+ * @brief A single timestamped XYZ acceleration sample
+ */
+struct KX134Frame
+{
+    /** @brief Time the sample was taken, in microseconds */
+    uint32_t timestamp;
+
+    /** @brief X acceleration in LSB */
+    int16_t x;
+
+    /** @brief Y acceleration in LSB */
+    int16_t y;
+
+    /** @brief Z acceleration in LSB */
+    int16_t z;
+};
+
+#endif
@@ -1,5 +1,8 @@
 #include "KX134I2C.h"
 #include "inttypes.h"
+#include "mbed_trace.h"
+
+#define TRACE_GROUP "KX134"
 
 #define KX_I2C_FREQ 100000
 
@@ -10,10 +13,10 @@ KX134I2C::KX134I2C(PinName sda, PinName scl, uint8_t i2c_addr_)
 {
 }
 
-bool KX134I2C::init()
+bool KX134I2C::configureBus()
 {
     i2c_.frequency(KX_I2C_FREQ);
-    return reset();
+    return true;
 }
 
 void KX134I2C::writeRegister(Register addr, char* tx_buf, char* rx_buf, int size)
@@ -25,61 +28,46 @@ void KX134I2C::writeRegister(Register addr, char* tx_buf, char* rx_buf, int size
     buf[0] = static_cast<char>(addr);
     memcpy(buf + 1, tx_buf, size);
 
-#if KX134_DEBUG
-    printf("Write Addr: 0x%" PRIx8 " Reg Addr: 0x%" PRIx8 "\r\n",
-        static_cast<uint8_t>(i2c_addr << 1 | 0),
-        buf[0]);
-
-    for (int i = 0; i < size; i++)
-    {
-        printf("0x%" PRIx8 " ", tx_buf[i]);
-    }
-#endif
-
+    uint32_t startUs = transactionStart();
     int ret = i2c_.write(i2c_addr << 1 | 0, reinterpret_cast<char*>(buf), size + 1, false);
 
-    (void)ret;
+    countTransaction(addr, true, size, startUs, ret != 0);
 
-#if KX134_DEBUG
     if (ret != 0)
     {
-        printf("WriteRegister: write failed!\r\n");
+        tr_error("WriteRegister: write to 0x%" PRIx8 " failed!", buf[0]);
+        return;
     }
-#endif
+
+    tr_debug("Write Addr: 0x%" PRIx8 " Reg Addr: 0x%" PRIx8 " Data: %s",
+        static_cast<uint8_t>(i2c_addr << 1 | 0),
+        buf[0],
+        tr_array(buf + 1, size));
 }
 
 void KX134I2C::readRegister(Register addr, char* rx_buf, int size)
 {
     char reg = static_cast<char>(addr);
 
-    int ret;
-    (void)ret;
-
-    ret = i2c_.write(i2c_addr << 1 | 0, &reg, 1, true);
+    uint32_t startUs = transactionStart();
+    int ret = i2c_.write(i2c_addr << 1 | 0, &reg, 1, true);
 
-#if KX134_DEBUG
-    if (ret != 0)
+    if (ret == 0)
     {
-        printf("ReadRegister: write failed!\r\n");
+        ret = i2c_.read(i2c_addr << 1 | 1, rx_buf, size);
     }
 
-    printf("Write Addr: 0x%" PRIx8 " Reg Addr: 0x%" PRIx8 "\r\n", i2c_addr << 1 | 0, reg);
-#endif
-
-    ret = i2c_.read(i2c_addr << 1 | 1, rx_buf, size);
+    countTransaction(addr, false, size, startUs, ret != 0);
 
-#if KX134_DEBUG
     if (ret != 0)
     {
-        printf("ReadRegister: read failed!\r\n");
+        tr_error("ReadRegister: read from 0x%" PRIx8 " failed!", static_cast<uint8_t>(reg));
+        memset(rx_buf, 0, size);
+        return;
     }
 
-    printf("Read Addr: 0x%" PRIx8 "\r\n", i2c_addr << 1 | 1);
-
-    for (int i = 0; i < size; i++)
-    {
-        printf("0x%" PRIx8 " ", rx_buf[i]);
-    }
-    printf("\r\n");
-#endif
+    tr_debug("Read Addr: 0x%" PRIx8 " Reg Addr: 0x%" PRIx8 " Data: %s",
+        static_cast<uint8_t>(i2c_addr << 1 | 1),
+        static_cast<uint8_t>(reg),
+        tr_array(reinterpret_cast<uint8_t*>(rx_buf), size));
 }
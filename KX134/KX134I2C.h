@@ -19,17 +19,19 @@ public:
      */
     KX134I2C(PinName sda, PinName scl, uint8_t i2c_addr_);
 
+protected:
     /**
-     * @brief Initializes the KX134
+     * @brief Sets the I2C frequency
      *
-     * @return true if the init is successful, false otherwise
+     * @return true
      */
-    virtual bool init() override;
+    virtual bool configureBus() override;
 
-protected:
     /**
      * @brief Reads a given register a given number of bytes
      *
+     * If the transfer fails, rx_buf is zeroed rather than left with stale or partial data.
+     *
      * @param[in] addr The register to read from
      * @param[out] rx_buf The buffer to read into
      * @param[in] size The number of bytes to read
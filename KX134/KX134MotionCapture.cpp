@@ -0,0 +1,128 @@
+#include "KX134MotionCapture.h"
+
+KX134MotionCapture::KX134MotionCapture(KX134Base& accel, EventQueue& queue)
+    : _accel(accel)
+    , _queue(queue)
+    , _settings {}
+    , _pin(KX134Base::InterruptPin::INT1)
+    , _state(State::IDLE)
+    , _endEvent(0)
+    , _captureCount(0)
+{
+}
+
+void KX134MotionCapture::start(KX134Base::InterruptPin pin, PinName mcuPin,
+    const Settings& settings, SamplesCallback onSamples)
+{
+    stop();
+
+    _settings = settings;
+    _pin = pin;
+    _onSamples = onSamples;
+
+    _accel.applyConfig(KX134Base::Config()
+                           .outputDataRate(settings.captureRate)
+                           .wakeUp(settings.wakeUpRate,
+                               settings.threshold,
+                               settings.delay,
+                               settings.directions)
+                           .noBuffer());
+
+    _accel.attachInterruptCallback(callback(this, &KX134MotionCapture::onInterrupt));
+    _accel.enableInterrupt(pin, mcuPin, KX134Base::INT_WAKE_UP | KX134Base::INT_WATERMARK);
+
+    goToSleep();
+}
+
+void KX134MotionCapture::stop()
+{
+    if (_state == State::IDLE)
+    {
+        return;
+    }
+
+    if (_endEvent != 0)
+    {
+        _queue.cancel(_endEvent);
+        _endEvent = 0;
+    }
+
+    _accel.disableInterrupt(_pin);
+    _accel.attachInterruptCallback(nullptr);
+    _accel.applyConfig(KX134Base::Config().noWakeUp().noBuffer());
+    _accel.clearInterrupts();
+
+    _state = State::IDLE;
+}
+
+KX134MotionCapture::State KX134MotionCapture::getState() const { return _state; }
+
+uint32_t KX134MotionCapture::captureCount() const { return _captureCount; }
+
+void KX134MotionCapture::onInterrupt(KX134Base::InterruptPin pin)
+{
+    (void)pin;
+
+    _queue.call(this, &KX134MotionCapture::process);
+}
+
+void KX134MotionCapture::process()
+{
+    if (_state == State::IDLE)
+    {
+        return;
+    }
+
+    uint8_t sources = _accel.getInterruptSources();
+    _accel.clearInterrupts();
+
+    if (_state == State::SLEEPING && (sources & KX134Base::INT_WAKE_UP))
+    {
+        // enabling the buffer restarts the KX134, so wake it explicitly afterwards
+        _accel.applyConfig(
+            KX134Base::Config().buffer(KX134Base::BufferMode::STREAM, _settings.watermark));
+        _accel.wake();
+        _accel.clearInterrupts();
+
+        _state = State::CAPTURING;
+        ++_captureCount;
+        _endEvent = _queue.call_in(_settings.duration, this, &KX134MotionCapture::endCapture);
+        return;
+    }
+
+    if (_state == State::CAPTURING && (sources & KX134Base::INT_WATERMARK))
+    {
+        drain();
+    }
+}
+
+void KX134MotionCapture::endCapture()
+{
+    _endEvent = 0;
+    if (_state != State::CAPTURING)
+    {
+        return;
+    }
+
+    drain();
+    _accel.applyConfig(KX134Base::Config().noBuffer());
+    goToSleep();
+}
+
+void KX134MotionCapture::drain()
+{
+    size_t count = _accel.readFrames(_frames, KX134Base::BUFFER_MAX_SAMPLES);
+
+    if (count != 0 && _onSamples)
+    {
+        _onSamples(_frames, count);
+    }
+}
+
+void KX134MotionCapture::goToSleep()
+{
+    _accel.sleep();
+    _accel.clearInterrupts();
+
+    _state = State::SLEEPING;
+}
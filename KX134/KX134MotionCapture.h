@@ -0,0 +1,164 @@
+#ifndef KX134MOTIONCAPTURE_H
+#define KX134MOTIONCAPTURE_H
+
+#include "mbed.h"
+#include "KX134Base.h"
+#include "KX134Frame.h"
+
+/**
+ * @brief Motion-triggered acquisition: sleeps in wake-up detection, captures after motion
+ *
+ * While idle, the KX134 sits in the sleep state, sampling slowly for the wake-up function only,
+ * and the MCU receives no interrupts. When motion crosses the wake-up threshold, the wake-up
+ * interrupt starts a capture: the sample buffer is enabled at the capture rate and drained on
+ * each watermark interrupt. After the capture duration, the buffer is disabled and the KX134 is
+ * put back to sleep.
+ *
+ * The state machine runs on an EventQueue; the interrupt handler only posts an event. It takes
+ * over the KX134's interrupt callback (see KX134Base::attachInterruptCallback()) while started.
+ */
+class KX134MotionCapture
+{
+public:
+    /**
+     * @brief The states of the capture
+     */
+    enum class State
+    {
+        /** Not started */
+        IDLE,
+        /** Waiting for motion in the sleep state */
+        SLEEPING,
+        /** Capturing at the capture rate */
+        CAPTURING
+    };
+
+    /**
+     * @brief Capture settings
+     */
+    struct Settings
+    {
+        /** @brief The output data rate of the capture */
+        KX134Base::OutputDataRate captureRate;
+
+        /** @brief The rate the wake-up function samples at while asleep */
+        KX134Base::WakeUpRate wakeUpRate;
+
+        /** @brief The wake-up threshold in WUFTH counts, see KX134Base::Config::wakeUp() */
+        uint16_t threshold;
+
+        /** @brief The number of wake-up samples the threshold must be exceeded for */
+        uint8_t delay;
+
+        /** @brief The KX134Base::MotionDirection bits that start a capture */
+        uint8_t directions;
+
+        /** @brief The buffer watermark, i.e. the number of samples delivered at once */
+        uint8_t watermark;
+
+        /** @brief How long each capture lasts */
+        std::chrono::milliseconds duration;
+    };
+
+    /**
+     * @brief Function receiving captured samples. Called on the EventQueue.
+     *
+     * Receives the frames and their number.
+     */
+    typedef Callback<void(const KX134Frame*, size_t)> SamplesCallback;
+
+    /**
+     * @brief Construct a new KX134MotionCapture
+     *
+     * @param[in] accel The initialized KX134
+     * @param[in] queue The EventQueue to run the state machine on
+     */
+    KX134MotionCapture(KX134Base& accel, EventQueue& queue);
+
+    /**
+     * @brief Configures the wake-up function and puts the KX134 to sleep, waiting for motion
+     *
+     * @param[in] pin The KX134 interrupt pin to use
+     * @param[in] mcuPin The MCU pin the KX134 interrupt pin is connected to
+     * @param[in] settings The capture settings
+     * @param[in] onSamples The function to deliver captured samples to
+     */
+    void start(KX134Base::InterruptPin pin, PinName mcuPin, const Settings& settings,
+        SamplesCallback onSamples);
+
+    /**
+     * @brief Stops waiting for motion or capturing, and disables the wake-up function
+     */
+    void stop();
+
+    /**
+     * @brief Returns the state of the capture
+     *
+     * @return The current State
+     */
+    State getState() const;
+
+    /**
+     * @brief Returns the number of captures started
+     *
+     * @return The number of captures since construction
+     */
+    uint32_t captureCount() const;
+
+private:
+    /**
+     * @brief Interrupt callback, posts process() to the EventQueue
+     *
+     * @param[in] pin The KX134 interrupt pin that fired
+     */
+    void onInterrupt(KX134Base::InterruptPin pin);
+
+    /**
+     * @brief Handles pending interrupt sources. Runs on the EventQueue.
+     */
+    void process();
+
+    /**
+     * @brief Ends the capture and goes back to sleep. Runs on the EventQueue.
+     */
+    void endCapture();
+
+    /**
+     * @brief Reads the buffered samples and delivers them
+     */
+    void drain();
+
+    /**
+     * @brief Puts the KX134 to sleep and waits for motion
+     */
+    void goToSleep();
+
+    /** @brief The KX134 */
+    KX134Base& _accel;
+
+    /** @brief The EventQueue the state machine runs on */
+    EventQueue& _queue;
+
+    /** @brief The capture settings */
+    Settings _settings;
+
+    /** @brief The interrupt pin in use */
+    KX134Base::InterruptPin _pin;
+
+    /** @brief The function to deliver samples to */
+    SamplesCallback _onSamples;
+
+    /** @brief The current state */
+    volatile State _state;
+
+    /** @brief The event ending the current capture, or 0 */
+    int _endEvent;
+
+    /** @brief The number of captures started */
+    uint32_t _captureCount;
+
+    /** @brief Frames of the block being delivered, kept off the event queue's stack */
+    KX134Frame _frames[KX134Base::BUFFER_MAX_SAMPLES];
+};
+
+#endif
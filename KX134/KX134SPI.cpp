@@ -1,93 +1,216 @@
 #include "KX134SPI.h"
 
-#define SPI_FREQ 1000000
+#include "mbed_trace.h"
+
+#define TRACE_GROUP "KX134"
+
+/* Default chip deselect time: one max-speed clock cycle */
+#define SPI_CS_DESELECT_NS 100
 
 KX134SPI::KX134SPI(PinName mosi, PinName miso, PinName sclk, PinName cs)
     : KX134Base()
-    , _spi(mosi, miso, sclk)
+    , _ownedBus(new KX134SPIBus(mosi, miso, sclk))
+    , _bus(*_ownedBus)
+    , _attached(_bus.attach(this))
     , _cs(cs)
+    , _csSetupNs(0)
+    , _csDeselectNs(SPI_CS_DESELECT_NS)
+#if DEVICE_SPI_ASYNCH
+    , _asyncTx(0)
+    , _asyncIndex(0)
+    , _asyncSamples(0)
+    , _asyncBytes(0)
+    , _asyncStartUs(0)
+    , _asyncBusy(false)
+#endif
 {
     deselect();
 }
 
-bool KX134SPI::init()
+KX134SPI::KX134SPI(KX134SPIBus& bus, PinName cs)
+    : KX134Base()
+    , _ownedBus(nullptr)
+    , _bus(bus)
+    , _attached(_bus.attach(this))
+    , _cs(cs)
+    , _csSetupNs(0)
+    , _csDeselectNs(SPI_CS_DESELECT_NS)
+#if DEVICE_SPI_ASYNCH
+    , _asyncTx(0)
+    , _asyncIndex(0)
+    , _asyncSamples(0)
+    , _asyncBytes(0)
+    , _asyncStartUs(0)
+    , _asyncBusy(false)
+#endif
 {
     deselect();
+}
 
-    _spi.frequency(SPI_FREQ);
-    _spi.format(8, 0);
+KX134SPI::~KX134SPI()
+{
+    if (_attached)
+    {
+        _bus.detach(this);
+    }
 
-    return reset();
+    delete _ownedBus;
 }
 
-void KX134SPI::readRegister(Register addr, char* rx_buf, int size)
+bool KX134SPI::configureBus()
+{
+    if (!_attached)
+    {
+        return false;
+    }
+
+    deselect();
+
+    return true;
+}
+
+void KX134SPI::setChipSelectTiming(uint32_t setupNs, uint32_t deselectNs)
 {
+    _csSetupNs = setupNs;
+    _csDeselectNs = deselectNs;
+}
+
+#if DEVICE_SPI_ASYNCH
+bool KX134SPI::readBufferAsync(size_t samples, const BufferReadCallback& onComplete)
+{
+    if (_asyncBusy)
+    {
+        return false;
+    }
+
+    if (samples == 0)
+    {
+        samples = getBufferSampleCount();
+    }
+    if (samples > getBufferCapacity())
+    {
+        samples = getBufferCapacity();
+    }
+    if (samples == 0)
+    {
+        return false;
+    }
+
+    _bus.lock();
+
+    _asyncBusy = true;
+    _bus._asyncActive = true;
+    _asyncIndex ^= 1;
+    _asyncSamples = samples;
+    _asyncBytes = samples * getBufferBytesPerSample();
+    _asyncCallback = onComplete;
+    _asyncTx = static_cast<uint8_t>(Register::BUF_READ) | 0x80;
+    _asyncStartUs = transactionStart();
+
     select();
 
-    /* Select the register to read */
-#if KX134_DEBUG
-    printf("Selected register 0x%" PRIX8 " and received 0x%X\r\n",
-        static_cast<uint8_t>(addr),
-#endif
-        _spi.write(static_cast<uint8_t>(addr) | 0x80)
-#if KX134_DEBUG
-    )
-#endif
-        ;
+    // the remaining bytes are clocked out with the default write value (0x00)
+    int result = _bus._spi.transfer(&_asyncTx,
+        1,
+        reinterpret_cast<char*>(_asyncBuffers[_asyncIndex]) + 1,
+        1 + _asyncBytes,
+        event_callback_t(this, &KX134SPI::onAsyncComplete),
+        SPI_EVENT_COMPLETE);
 
-    for (int i = 0; i < size; ++i)
+    if (result != 0)
     {
-        rx_buf[i] = _spi.write(0x00);
-#if KX134_DEBUG
-        printf(
-            "Read 0x%X from register 0x%" PRIX8 "\r\n", rx_buf[i], static_cast<uint8_t>(addr));
-#endif
+        // the transfer was rejected (e.g. the peripheral is busy), onAsyncComplete() will not run
+        deselect();
+        _asyncBusy = false;
+        _bus._asyncActive = false;
+        _bus.unlock();
+
+        return false;
+    }
+
+    _bus.unlock();
+
+    return true;
+}
+
+bool KX134SPI::asyncBusy() const { return _asyncBusy; }
+
+void KX134SPI::onAsyncComplete(int event)
+{
+    (void)event;
+
+    deselect();
+
+    // the bus stays busy until here, so no other transaction of this driver is counted meanwhile
+    countTransaction(Register::BUF_READ, false, _asyncBytes, _asyncStartUs);
+
+    int16_t* output = _asyncBuffers[_asyncIndex] + 1;
+    unpackBufferSamples(reinterpret_cast<const char*>(output), output, _asyncSamples);
+
+    _asyncBusy = false;
+    _bus._asyncActive = false;
+
+    if (_asyncCallback)
+    {
+        _asyncCallback(output, _asyncSamples);
     }
+}
+#endif
+
+void KX134SPI::readRegister(Register addr, char* rx_buf, int size)
+{
+    _bus.lock();
+    uint32_t startUs = transactionStart();
+    select();
+
+    /* Select the register to read, then clock in the whole response as one block */
+    _bus._spi.write(static_cast<uint8_t>(addr) | 0x80);
+    _bus._spi.write(nullptr, 0, rx_buf, size);
 
     deselect();
+    countTransaction(addr, false, size, startUs);
+    _bus.unlock();
+
+    tr_debug("Read %s from register 0x%" PRIX8,
+        tr_array(reinterpret_cast<uint8_t*>(rx_buf), size),
+        static_cast<uint8_t>(addr));
 }
 
 void KX134SPI::writeRegister(Register addr, char* tx_buf, char* rx_buf, int size)
 {
+    _bus.lock();
+    uint32_t startUs = transactionStart();
     select();
 
-    _spi.write(static_cast<uint8_t>(addr)); // select register
-    for (int i = 0; i < size; ++i)
-    {
-        if (rx_buf != nullptr)
-        {
-            rx_buf[i] = _spi.write(tx_buf[i]);
-#if KX134_DEBUG
-            printf("Wrote 0x%X to register 0x%" PRIX8 " and received 0x%X\r\n",
-                tx_buf[i],
-                static_cast<uint8_t>(addr),
-                rx_buf[i]);
-#endif
-        }
-        else
-        {
-#if KX134_DEBUG
-            printf("Wrote 0x%X to register 0x%" PRIX8 " and received 0x%X\r\n",
-                tx_buf[i],
-                static_cast<uint8_t>(addr),
-#endif
-                _spi.write(tx_buf[i])
-#if KX134_DEBUG
-            )
-#endif
-                ;
-        }
-    }
+    _bus._spi.write(static_cast<uint8_t>(addr)); // select register
+    _bus._spi.write(tx_buf, size, rx_buf, rx_buf != nullptr ? size : 0);
 
     deselect();
+    countTransaction(addr, true, size, startUs);
+    _bus.unlock();
+
+    tr_debug("Wrote %s to register 0x%" PRIX8,
+        tr_array(reinterpret_cast<uint8_t*>(tx_buf), size),
+        static_cast<uint8_t>(addr));
 }
 
 void KX134SPI::deselect()
 {
     _cs.write(1);
 
-    /* Delay one max-speed clock cycle (100ns) to ensure chip is ready by next write */
-    wait_us(1);
+    /* Keep the chip deselected long enough to be ready by the next transaction */
+    if (_csDeselectNs != 0)
+    {
+        wait_ns(_csDeselectNs);
+    }
 }
 
-void KX134SPI::select() { _cs.write(0); }
+void KX134SPI::select()
+{
+    _cs.write(0);
+
+    if (_csSetupNs != 0)
+    {
+        wait_ns(_csSetupNs);
+    }
+}
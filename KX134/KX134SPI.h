@@ -2,6 +2,7 @@
 #define KX134SPI_H
 
 #include "KX134Base.h"
+#include "KX134SPIBus.h"
 
 /**
  * @brief SPI implementation of KX134 driver
@@ -20,13 +21,72 @@ public:
     KX134SPI(PinName mosi, PinName miso, PinName sclk, PinName cs);
 
     /**
-     * @brief Initializes the KX134
+     * @brief Construct a new KX134 driver on an SPI bus shared with other KX134s
      *
-     * @return true if the init is successful, false otherwise
+     * The bus must outlive the driver. At most KX134SPIBus::MAX_DEVICES drivers can share a bus;
+     * init() fails for the others.
+     *
+     * @param[in] bus The shared SPI bus
+     * @param[in] cs The chip select pin
+     */
+    KX134SPI(KX134SPIBus& bus, PinName cs);
+
+    /**
+     * @brief Destroy the KX134SPI, detaching it from the bus
+     */
+    virtual ~KX134SPI();
+
+    /**
+     * @brief Sets the chip select timing
+     *
+     * @param[in] setupNs The time in nanoseconds to wait after selecting the chip before clocking
+     * @param[in] deselectNs The time in nanoseconds to keep the chip deselected after a
+     * transaction, before the next one may start
+     */
+    void setChipSelectTiming(uint32_t setupNs, uint32_t deselectNs);
+
+#if DEVICE_SPI_ASYNCH
+    /**
+     * @brief Function called when an asynchronous buffer read completes
+     *
+     * Receives the samples (as consecutive X, Y, Z triples) and the number of samples read.
      */
-    virtual bool init() override;
+    typedef Callback<void(const int16_t*, size_t)> BufferReadCallback;
+
+    /**
+     * @brief Starts draining the sample buffer using a non-blocking (DMA) SPI transfer
+     *
+     * Reads are double-buffered: the samples passed to the callback stay valid until the second
+     * following readBufferAsync() call, so the previous block can be processed while the next one
+     * is transferred. The callback is executed in interrupt context.
+     *
+     * Other transactions on the bus, from this or any other KX134, wait until the transfer
+     * completes.
+     *
+     * @param[in] samples The number of samples to read, e.g. the watermark after a watermark
+     * interrupt. Clamped to the buffer capacity. If 0, the buffer level is read first (blocking).
+     * @param[in] onComplete The function to call once the samples have been read
+     * @return true if a transfer was started, false if one is already in progress, there are no
+     * samples to read or the SPI peripheral rejected the transfer
+     */
+    bool readBufferAsync(size_t samples, const BufferReadCallback& onComplete);
+
+    /**
+     * @brief Returns if an asynchronous buffer read is in progress
+     *
+     * @return true if a transfer is in progress, false otherwise
+     */
+    bool asyncBusy() const;
+#endif
 
 protected:
+    /**
+     * @brief Deselects the chip. Fails if the bus already has KX134SPIBus::MAX_DEVICES drivers.
+     *
+     * @return true if the bus is ready, false otherwise
+     */
+    virtual bool configureBus() override;
+
     /**
      * @brief Reads a given register a given number of bytes
      *
@@ -57,11 +117,66 @@ protected:
     void select();
 
 private:
-    /** @brief The SPI interface */
-    SPI _spi;
+    friend class KX134SPIBus;
+
+#if DEVICE_SPI_ASYNCH
+    /**
+     * @brief Completes an asynchronous buffer read. Called from interrupt context.
+     *
+     * @param[in] event The SPI event flags
+     */
+    void onAsyncComplete(int event);
+#endif
+
+    /** @brief The bus created by the legacy constructor, deleted with the driver */
+    KX134SPIBus* _ownedBus;
+
+    /** @brief The SPI bus */
+    KX134SPIBus& _bus;
+
+    /** @brief Whether the driver is attached to the bus */
+    bool _attached;
 
     /** @brief The chip select pin */
     DigitalOut _cs;
+
+    /** @brief Time in nanoseconds between selecting the chip and the first clock */
+    uint32_t _csSetupNs;
+
+    /** @brief Minimum time in nanoseconds the chip stays deselected between transactions */
+    uint32_t _csDeselectNs;
+
+#if DEVICE_SPI_ASYNCH
+    /**
+     * @brief Double-buffered storage for asynchronous buffer reads
+     *
+     * The received bytes start at byte offset 1, so the dummy byte clocked in while sending the
+     * register address lands in the first element's high byte and the samples end up aligned from
+     * the second element, where they are converted in place.
+     */
+    int16_t _asyncBuffers[2][1 + BUFFER_MAX_SAMPLES * 3];
+
+    /** @brief The register address sent at the start of an asynchronous read */
+    char _asyncTx;
+
+    /** @brief The index of _asyncBuffers used by the transfer in progress */
+    uint8_t _asyncIndex;
+
+    /** @brief The number of samples requested by the transfer in progress */
+    size_t _asyncSamples;
+
+    /** @brief The number of sample bytes read by the transfer in progress */
+    size_t _asyncBytes;
+
+    /** @brief The transactionStart() time of the transfer in progress */
+    uint32_t _asyncStartUs;
+
+    /** @brief Set while an asynchronous transfer is in progress */
+    volatile bool _asyncBusy;
+
+    /** @brief The function to call when the transfer in progress completes */
+    BufferReadCallback _asyncCallback;
+#endif
 };
 
 #endif
@@ -0,0 +1,106 @@
+#include "KX134SPIBus.h"
+#include "KX134SPI.h"
+
+#define SPI_FREQ 1000000
+
+constexpr size_t KX134SPIBus::MAX_DEVICES;
+
+KX134SPIBus::KX134SPIBus(PinName mosi, PinName miso, PinName sclk)
+    : _spi(mosi, miso, sclk)
+    , _devices{}
+    , _deviceCount(0)
+    , _asyncActive(false)
+{
+    _spi.frequency(SPI_FREQ);
+    _spi.format(8, 0);
+    _spi.set_default_write_value(0x00);
+
+#if DEVICE_SPI_ASYNCH
+    _spi.set_dma_usage(DMA_USAGE_ALWAYS);
+#endif
+}
+
+void KX134SPIBus::frequency(int hz)
+{
+    lock();
+    _spi.frequency(hz);
+    unlock();
+}
+
+void KX134SPIBus::lock()
+{
+    _spi.lock();
+
+    /* An asynchronous transfer completes in interrupt context, where the lock cannot be released */
+    while (_asyncActive)
+    {
+        ThisThread::yield();
+    }
+}
+
+void KX134SPIBus::unlock() { _spi.unlock(); }
+
+size_t KX134SPIBus::deviceCount() const { return _deviceCount; }
+
+std::chrono::microseconds KX134SPIBus::sampleAll(
+    int16_t* const* outputs, size_t* counts, size_t maxSamples)
+{
+    lock();
+
+    /* Snapshot every buffer level first: the samples up to each level end within this window */
+    _skewTimer.reset();
+    for (size_t i = 0; i < _deviceCount; ++i)
+    {
+        if (i == 1)
+        {
+            _skewTimer.start();
+        }
+
+        counts[i] = _devices[i]->beginBufferRead(_devices[i]->getBufferSampleCount(), maxSamples);
+    }
+    _skewTimer.stop();
+
+    for (size_t i = 0; i < _deviceCount; ++i)
+    {
+        _devices[i]->readBufferSamples(outputs[i], counts[i]);
+    }
+
+    unlock();
+
+    return _skewTimer.elapsed_time();
+}
+
+bool KX134SPIBus::attach(KX134SPI* device)
+{
+    lock();
+
+    bool attached = _deviceCount < MAX_DEVICES;
+    if (attached)
+    {
+        _devices[_deviceCount++] = device;
+    }
+
+    unlock();
+
+    return attached;
+}
+
+void KX134SPIBus::detach(KX134SPI* device)
+{
+    lock();
+
+    for (size_t i = 0; i < _deviceCount; ++i)
+    {
+        if (_devices[i] == device)
+        {
+            for (size_t j = i + 1; j < _deviceCount; ++j)
+            {
+                _devices[j - 1] = _devices[j];
+            }
+            --_deviceCount;
+            break;
+        }
+    }
+
+    unlock();
+}
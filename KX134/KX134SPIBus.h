@@ -0,0 +1,107 @@
+#ifndef KX134SPIBUS_H
+#define KX134SPIBUS_H
+
+#include "mbed.h"
+
+class KX134SPI;
+
+/**
+ * @brief An SPI bus shared by several KX134s, each with its own chip select pin
+ *
+ * Owns the SPI interface and serializes the transactions of the KX134SPI drivers attached to it:
+ * each transaction holds the bus lock from selecting the chip to deselecting it, and no other
+ * transaction starts while an asynchronous buffer read is in progress.
+ */
+class KX134SPIBus
+{
+public:
+    /** @brief The most KX134s that can share one bus */
+    static constexpr size_t MAX_DEVICES = 8;
+
+    /**
+     * @brief Construct a new shared SPI bus
+     *
+     * @param[in] mosi The SPI MOSI pin
+     * @param[in] miso The SPI MISO pin
+     * @param[in] sclk The SPI SCLK pin
+     */
+    KX134SPIBus(PinName mosi, PinName miso, PinName sclk);
+
+    /**
+     * @brief Sets the SPI clock frequency used by all devices on the bus
+     *
+     * @param[in] hz The clock frequency in Hz
+     */
+    void frequency(int hz);
+
+    /**
+     * @brief Acquires exclusive access to the bus
+     *
+     * Waits for any asynchronous transfer in progress to complete. May be nested.
+     */
+    void lock();
+
+    /**
+     * @brief Releases exclusive access to the bus
+     */
+    void unlock();
+
+    /**
+     * @brief Returns the number of KX134s attached to the bus
+     *
+     * @return The number of attached KX134s
+     */
+    size_t deviceCount() const;
+
+    /**
+     * @brief Drains the sample buffer of every attached KX134 in one bus session
+     *
+     * The buffer levels of all devices are read back-to-back first, so the samples returned for
+     * each device end at nearly the same instant, then the samples are read. The skew between
+     * devices is bounded by the time to read the levels, not by the time to read the samples.
+     *
+     * Samples beyond maxSamples stay buffered for the next call.
+     *
+     * @param[out] outputs For each device, in attach order, an array of at least maxSamples * 3
+     * elements receiving the samples as consecutive X, Y, Z triples
+     * @param[out] counts For each device, in attach order, the number of samples read
+     * @param[in] maxSamples The most samples to read from each device
+     * @return The time between reading the first and the last device's buffer level
+     */
+    std::chrono::microseconds sampleAll(int16_t* const* outputs, size_t* counts, size_t maxSamples);
+
+private:
+    friend class KX134SPI;
+
+    /**
+     * @brief Attaches a KX134 to the bus
+     *
+     * @param[in] device The KX134 to attach
+     * @return true if attached, false if the bus already has MAX_DEVICES KX134s
+     */
+    bool attach(KX134SPI* device);
+
+    /**
+     * @brief Detaches a KX134 from the bus
+     *
+     * @param[in] device The KX134 to detach
+     */
+    void detach(KX134SPI* device);
+
+    /** @brief The SPI interface */
+    SPI _spi;
+
+    /** @brief The attached KX134s, in attach order */
+    KX134SPI* _devices[MAX_DEVICES];
+
+    /** @brief The number of attached KX134s */
+    size_t _deviceCount;
+
+    /** @brief Set while an asynchronous transfer is in progress */
+    volatile bool _asyncActive;
+
+    /** @brief Measures the skew of sampleAll() */
+    Timer _skewTimer;
+};
+
+#endif
@@ -0,0 +1,72 @@
+#include "KX134SampleClock.h"
+
+#include <cmath>
+
+/* Period measurements further than this from nominal are discarded (missed or spurious anchors) */
+#define SAMPLE_CLOCK_MAX_ERROR 0.1f
+
+/* Periods are measured from a reference anchor once this many samples away, which renews it */
+#define SAMPLE_CLOCK_BASELINE 4096
+
+KX134SampleClock::KX134SampleClock(float smoothing)
+    : _smoothing(smoothing)
+{
+    reset(1.0f);
+}
+
+void KX134SampleClock::reset(float nominalHz)
+{
+    _nominalPeriodUs = 1000000.0f / nominalHz;
+    _periodUs = _nominalPeriodUs;
+    restart();
+}
+
+void KX134SampleClock::restart()
+{
+    _anchorTimeUs = 0;
+    _anchorIndex = 0;
+    _referenceTimeUs = 0;
+    _referenceIndex = 0;
+    _anchored = false;
+}
+
+void KX134SampleClock::anchor(uint32_t timeUs, uint32_t sampleIndex)
+{
+    if (!_anchored)
+    {
+        _referenceTimeUs = timeUs;
+        _referenceIndex = sampleIndex;
+    }
+
+    // measuring over a long baseline divides the anchors' jitter by the number of samples.
+    // Shorter baselines, such as the anchors just after the reference was renewed, would pass
+    // their full jitter on to the period, so they are not measured.
+    int32_t samples = static_cast<int32_t>(sampleIndex - _referenceIndex);
+    if (samples >= SAMPLE_CLOCK_BASELINE)
+    {
+        float measured = static_cast<float>(timeUs - _referenceTimeUs) / samples;
+        if (std::fabs(measured - _nominalPeriodUs) <= SAMPLE_CLOCK_MAX_ERROR * _nominalPeriodUs)
+        {
+            _periodUs += _smoothing * (measured - _periodUs);
+        }
+
+        _referenceTimeUs = timeUs;
+        _referenceIndex = sampleIndex;
+    }
+
+    _anchorTimeUs = timeUs;
+    _anchorIndex = sampleIndex;
+    _anchored = true;
+}
+
+bool KX134SampleClock::anchored() const { return _anchored; }
+
+uint32_t KX134SampleClock::timestamp(uint32_t sampleIndex) const
+{
+    int32_t samples = static_cast<int32_t>(sampleIndex - _anchorIndex);
+    return _anchorTimeUs + static_cast<int32_t>(std::lround(samples * _periodUs));
+}
+
+float KX134SampleClock::getRateHz() const { return 1000000.0f / _periodUs; }
+
+float KX134SampleClock::getDriftPpm() const { return (_nominalPeriodUs / _periodUs - 1.0f) * 1e6f; }
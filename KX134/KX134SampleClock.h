@@ -0,0 +1,110 @@
+#ifndef KX134SAMPLECLOCK_H
+#define KX134SAMPLECLOCK_H
+
+#include "mbed.h"
+
+/**
+ * @brief Reconstructs when each KX134 sample was taken from occasional timestamped anchors
+ *
+ * Samples are numbered by a free-running index. An anchor pairs a sample index with the MCU time
+ * the sample was taken, e.g. the time of a watermark interrupt and the index of the newest
+ * buffered sample. Between and after anchors, sample times are extrapolated with the sample
+ * period.
+ *
+ * The sample period starts at the nominal ODR and is refined from the time elapsed between anchors
+ * several thousand samples apart, smoothed with an exponential moving average, so interrupt
+ * latency jitter averages out. Anchors closer to the reference anchor do not refine it. This
+ * tracks the drift of the KX134's oscillator against the MCU clock.
+ *
+ * All times are in microseconds and wrap around like the uint32_t they are stored in.
+ */
+class KX134SampleClock
+{
+public:
+    /**
+     * @brief Construct a new KX134SampleClock
+     *
+     * @param[in] smoothing The weight of each new period measurement, from 0 (never adapt) to 1
+     * (use the last measurement only)
+     */
+    KX134SampleClock(float smoothing = 0.1f);
+
+    /**
+     * @brief Restarts at a new nominal rate, discarding the anchor and the measured period
+     *
+     * @param[in] nominalHz The nominal output data rate
+     */
+    void reset(float nominalHz);
+
+    /**
+     * @brief Discards the anchor, keeping the measured period
+     *
+     * Call when samples were lost (e.g. the buffer was cleared), so the next period measurement
+     * does not span them.
+     */
+    void restart();
+
+    /**
+     * @brief Records the time a sample was taken
+     *
+     * @param[in] timeUs The time the sample was taken
+     * @param[in] sampleIndex The index of the sample
+     */
+    void anchor(uint32_t timeUs, uint32_t sampleIndex);
+
+    /**
+     * @brief Returns if an anchor has been recorded since the last reset() or restart()
+     *
+     * @return true if anchored, false otherwise
+     */
+    bool anchored() const;
+
+    /**
+     * @brief Returns the time a sample was taken
+     *
+     * @param[in] sampleIndex The index of the sample
+     * @return The time the sample was taken, extrapolated from the last anchor
+     */
+    uint32_t timestamp(uint32_t sampleIndex) const;
+
+    /**
+     * @brief Returns the measured output data rate
+     *
+     * @return The rate in Hz, in MCU time
+     */
+    float getRateHz() const;
+
+    /**
+     * @brief Returns the difference between the measured and the nominal output data rate
+     *
+     * @return The drift in parts per million. Positive when the KX134 runs fast.
+     */
+    float getDriftPpm() const;
+
+private:
+    /** @brief The weight of each new period measurement */
+    float _smoothing;
+
+    /** @brief The nominal sample period */
+    float _nominalPeriodUs;
+
+    /** @brief The measured sample period */
+    float _periodUs;
+
+    /** @brief The time of the last anchor */
+    uint32_t _anchorTimeUs;
+
+    /** @brief The sample index of the last anchor */
+    uint32_t _anchorIndex;
+
+    /** @brief The time of the anchor periods are measured from */
+    uint32_t _referenceTimeUs;
+
+    /** @brief The sample index of the anchor periods are measured from */
+    uint32_t _referenceIndex;
+
+    /** @brief Whether an anchor has been recorded */
+    bool _anchored;
+};
+
+#endif
@@ -0,0 +1,69 @@
+#include "KX134SampleRing.h"
+
+KX134SampleRing::KX134SampleRing(Span<KX134Frame> storage)
+    : _frames(storage.data())
+    , _mask(storage.size() - 1)
+    , _head(0)
+    , _tail(0)
+    , _drops(0)
+{
+    MBED_ASSERT(storage.size() > 0 && (storage.size() & _mask) == 0);
+}
+
+bool KX134SampleRing::push(const KX134Frame& frame) { return push(&frame, 1) == 1; }
+
+size_t KX134SampleRing::push(const KX134Frame* frames, size_t count)
+{
+    const size_t head = _head.load(std::memory_order_relaxed);
+    const size_t tail = _tail.load(std::memory_order_acquire);
+
+    size_t free = capacity() - (head - tail);
+    size_t stored = count < free ? count : free;
+
+    for (size_t i = 0; i < stored; ++i)
+    {
+        _frames[(head + i) & _mask] = frames[i];
+    }
+
+    // publish the frames to the consumer
+    _head.store(head + stored, std::memory_order_release);
+
+    if (stored < count)
+    {
+        _drops.store(_drops.load(std::memory_order_relaxed) + (count - stored),
+            std::memory_order_relaxed);
+    }
+
+    return stored;
+}
+
+bool KX134SampleRing::pop(KX134Frame& frame) { return pop(Span<KX134Frame>(&frame, 1)) == 1; }
+
+size_t KX134SampleRing::pop(Span<KX134Frame> output)
+{
+    const size_t tail = _tail.load(std::memory_order_relaxed);
+    const size_t head = _head.load(std::memory_order_acquire);
+
+    size_t available = head - tail;
+    const size_t requested = static_cast<size_t>(output.size());
+    size_t popped = requested < available ? requested : available;
+
+    for (size_t i = 0; i < popped; ++i)
+    {
+        output[i] = _frames[(tail + i) & _mask];
+    }
+
+    // hand the slots back to the producer
+    _tail.store(tail + popped, std::memory_order_release);
+
+    return popped;
+}
+
+size_t KX134SampleRing::size() const
+{
+    return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+}
+
+size_t KX134SampleRing::capacity() const { return _mask + 1; }
+
+uint32_t KX134SampleRing::dropCount() const { return _drops.load(std::memory_order_relaxed); }
@@ -0,0 +1,122 @@
+#ifndef KX134SAMPLERING_H
+#define KX134SAMPLERING_H
+
+#include "mbed.h"
+#include "KX134Frame.h"
+
+#include <atomic>
+
+/**
+ * @brief Lock-free single-producer/single-consumer ring of KX134Frames
+ *
+ * One context (typically the data-ready or watermark path, which may run in interrupt context)
+ * pushes frames, and one application thread pops them. Neither side blocks: when the ring is full,
+ * new frames are dropped and counted.
+ *
+ * The storage is provided by the owner; see KX134StaticSampleRing for a statically-allocated ring.
+ */
+class KX134SampleRing
+{
+public:
+    /**
+     * @brief Construct a new KX134SampleRing over caller-owned storage
+     *
+     * @param[in] storage The frames to use as the ring. Its size must be a power of two.
+     */
+    KX134SampleRing(Span<KX134Frame> storage);
+
+    /**
+     * @brief Pushes one frame. Producer side only.
+     *
+     * @param[in] frame The frame to push
+     * @return true if the frame was stored, false if the ring was full and it was dropped
+     */
+    bool push(const KX134Frame& frame);
+
+    /**
+     * @brief Pushes several frames. Producer side only.
+     *
+     * @param[in] frames The frames to push
+     * @param[in] count The number of frames to push
+     * @return The number of frames stored. The rest were dropped.
+     */
+    size_t push(const KX134Frame* frames, size_t count);
+
+    /**
+     * @brief Pops one frame. Consumer side only.
+     *
+     * @param[out] frame The frame that was popped
+     * @return true if a frame was popped, false if the ring was empty
+     */
+    bool pop(KX134Frame& frame);
+
+    /**
+     * @brief Pops as many frames as are available, up to the size of the output. Consumer side
+     * only.
+     *
+     * @param[out] output The frames to pop into
+     * @return The number of frames popped
+     */
+    size_t pop(Span<KX134Frame> output);
+
+    /**
+     * @brief Returns the number of frames waiting to be popped
+     *
+     * @return The number of frames in the ring
+     */
+    size_t size() const;
+
+    /**
+     * @brief Returns the number of frames the ring can hold
+     *
+     * @return The capacity of the ring
+     */
+    size_t capacity() const;
+
+    /**
+     * @brief Returns the number of frames dropped because the ring was full
+     *
+     * @return The number of dropped frames since construction
+     */
+    uint32_t dropCount() const;
+
+private:
+    /** @brief The frame storage */
+    KX134Frame* const _frames;
+
+    /** @brief Capacity - 1, used to wrap indices */
+    const size_t _mask;
+
+    /** @brief Free-running count of frames pushed. Written by the producer only. */
+    std::atomic<size_t> _head;
+
+    /** @brief Free-running count of frames popped. Written by the consumer only. */
+    std::atomic<size_t> _tail;
+
+    /** @brief Number of frames dropped. Written by the producer only. */
+    std::atomic<uint32_t> _drops;
+};
+
+/**
+ * @brief KX134SampleRing with statically-allocated storage
+ *
+ * @tparam N The number of frames to hold. Must be a power of two.
+ */
+template <size_t N> class KX134StaticSampleRing : public KX134SampleRing
+{
+    static_assert(N > 0 && (N & (N - 1)) == 0, "KX134StaticSampleRing size must be a power of two");
+
+public:
+    /**
+     * @brief Construct a new, empty KX134StaticSampleRing
+     */
+    KX134StaticSampleRing()
+        : KX134SampleRing(Span<KX134Frame>(_storage, N))
+    {
+    }
+
+private:
+    KX134Frame _storage[N];
+};
+
+#endif
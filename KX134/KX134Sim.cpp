@@ -0,0 +1,466 @@
+#include "KX134Sim.h"
+
+/* Default modeled bus timing: SPI at 1MHz */
+#define SIM_NS_PER_BYTE 8000
+#define SIM_NS_PER_TRANSACTION 1000
+
+/* Sample period at OSA = 0 (0.781Hz) in nanoseconds. Each OSA step halves it. */
+#define SIM_BASE_PERIOD_NS 1280000000ULL
+
+constexpr size_t KX134Sim::SIM_BUFFER_SAMPLES;
+
+KX134Sim::KX134Sim()
+    : KX134Base()
+    , _nowNs(0)
+    , _operatingSinceNs(0)
+    , _samplesSinceOperating(0)
+    , _nsPerByte(SIM_NS_PER_BYTE)
+    , _nsPerTransaction(SIM_NS_PER_TRANSACTION)
+    , _noiseState(1)
+    , _ignoredWrites(0)
+    , _signalSource(this, &KX134Sim::restSignal)
+{
+    powerOn();
+}
+
+void KX134Sim::setBusTiming(uint32_t nsPerByte, uint32_t nsPerTransaction)
+{
+    _nsPerByte = nsPerByte;
+    _nsPerTransaction = nsPerTransaction;
+}
+
+void KX134Sim::setSignalSource(SignalSource source)
+{
+    _signalSource = source ? source : SignalSource(this, &KX134Sim::restSignal);
+}
+
+void KX134Sim::advance(std::chrono::microseconds duration) { elapse(duration.count() * 1000ULL); }
+
+uint64_t KX134Sim::now() const { return _nowNs; }
+
+uint32_t KX134Sim::timeUs() { return static_cast<uint32_t>(_nowNs / 1000); }
+
+void KX134Sim::trigger(uint8_t sources)
+{
+    const bool triggerMode
+        = (_regs[static_cast<uint8_t>(Register::BUF_CNTL2)] & BUF_CNTL2_BM)
+        == static_cast<uint8_t>(BufferMode::TRIGGER);
+
+    if (triggerMode && !_triggered)
+    {
+        _triggered = true;
+        updateBufferStatus();
+    }
+
+    // the tilt and tap status share the InterruptSource layout of INS2 (a single tap)
+    raise(sources & (INT_TILT | INT_TAP));
+}
+
+uint32_t KX134Sim::ignoredWrites() const { return _ignoredWrites; }
+
+void KX134Sim::readRegister(Register addr, char* rx_buf, int size)
+{
+    uint32_t startUs = transactionStart();
+    elapse(_nsPerTransaction + static_cast<uint64_t>(size + 1) * _nsPerByte);
+    countTransaction(addr, false, size, startUs);
+
+    for (int i = 0; i < size; ++i)
+    {
+        // BUF_READ does not auto-increment
+        uint8_t reg = addr == Register::BUF_READ ? static_cast<uint8_t>(addr)
+                                                 : static_cast<uint8_t>(addr) + i;
+        rx_buf[i] = readOne(reg & 0x7F);
+    }
+}
+
+void KX134Sim::writeRegister(Register addr, char* data, char* rx_buf, int size)
+{
+    uint32_t startUs = transactionStart();
+    elapse(_nsPerTransaction + static_cast<uint64_t>(size + 1) * _nsPerByte);
+    countTransaction(addr, true, size, startUs);
+
+    for (int i = 0; i < size; ++i)
+    {
+        if (rx_buf != nullptr)
+        {
+            rx_buf[i] = 0;
+        }
+        writeOne((static_cast<uint8_t>(addr) + i) & 0x7F, data[i]);
+    }
+}
+
+void KX134Sim::powerOn()
+{
+    memset(_regs, 0, sizeof(_regs));
+
+    // power-on values of the registers the driver depends on
+    _regs[static_cast<uint8_t>(Register::MAN_ID)] = 0x4B;
+    _regs[static_cast<uint8_t>(Register::COTR)] = 0x55;
+    _regs[static_cast<uint8_t>(Register::WHO_AM_I)] = 0x46;
+    _regs[static_cast<uint8_t>(Register::CNTL2)] = 0x3F;
+    _regs[static_cast<uint8_t>(Register::CNTL3)] = 0xA8;
+    _regs[static_cast<uint8_t>(Register::CNTL4)] = 0x40;
+    _regs[static_cast<uint8_t>(Register::ODCNTL)] = 0x06;
+    _regs[static_cast<uint8_t>(Register::INC1)] = 0x10;
+    _regs[static_cast<uint8_t>(Register::INC3)] = 0x3F;
+    _regs[static_cast<uint8_t>(Register::INC5)] = 0x10;
+    _regs[static_cast<uint8_t>(Register::TDTRC)] = 0x03;
+    _regs[static_cast<uint8_t>(Register::TDTC)] = 0x78;
+    _regs[static_cast<uint8_t>(Register::TTH)] = 0xCB;
+    _regs[static_cast<uint8_t>(Register::TTL)] = 0x1A;
+    _regs[static_cast<uint8_t>(Register::FTD)] = 0xA2;
+    _regs[static_cast<uint8_t>(Register::STD)] = 0x24;
+    _regs[static_cast<uint8_t>(Register::TLT)] = 0x28;
+    _regs[static_cast<uint8_t>(Register::TWS)] = 0xA0;
+    _regs[static_cast<uint8_t>(Register::TILT_ANGLE_LL)] = 0x0C;
+    _regs[static_cast<uint8_t>(Register::TILT_ANGLE_HL)] = 0x2A;
+    _regs[static_cast<uint8_t>(Register::HYST_SET)] = 0x14;
+    _regs[static_cast<uint8_t>(Register::LP_CNTL1)] = 0x7B;
+
+    _bufferHead = 0;
+    _bufferCount = 0;
+    _bufferByteOffset = 0;
+    _triggered = false;
+}
+
+uint8_t KX134Sim::readOne(uint8_t addr)
+{
+    uint8_t value = _regs[addr];
+
+    switch (static_cast<Register>(addr))
+    {
+        case Register::COTR:
+            // reading COTR completes the command test
+            _regs[addr] = 0x55;
+            break;
+
+        case Register::ZOUT_H:
+            // reading the outputs clears data ready
+            _regs[static_cast<uint8_t>(Register::INS2)] &= ~INT_DATA_READY;
+            break;
+
+        case Register::INT_REL:
+            // releases latched interrupts
+            _regs[static_cast<uint8_t>(Register::INS1)] = 0;
+            _regs[static_cast<uint8_t>(Register::INS2)] &= INT_WATERMARK | INT_BUFFER_FULL;
+            _regs[static_cast<uint8_t>(Register::INS3)] = 0;
+            _regs[static_cast<uint8_t>(Register::STATUS_REG)] = 0;
+            break;
+
+        case Register::BUF_READ:
+        {
+            if (_bufferCount == 0)
+            {
+                return 0;
+            }
+
+            // 16-bit samples are X_L X_H Y_L Y_H Z_L Z_H, 8-bit samples are X_H Y_H Z_H
+            const int16_t* sample = _buffer[_bufferHead];
+            if (bufferBytesPerSample() == BUFFER_BYTES_PER_SAMPLE)
+            {
+                uint16_t word = static_cast<uint16_t>(sample[_bufferByteOffset / 2]);
+                value = _bufferByteOffset % 2 ? word >> 8 : word & 0xFF;
+            }
+            else
+            {
+                value = static_cast<uint16_t>(sample[_bufferByteOffset]) >> 8;
+            }
+
+            if (++_bufferByteOffset == bufferBytesPerSample())
+            {
+                _bufferByteOffset = 0;
+                _bufferHead = (_bufferHead + 1) % SIM_BUFFER_SAMPLES;
+                --_bufferCount;
+            }
+            updateBufferStatus();
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return value;
+}
+
+void KX134Sim::writeOne(uint8_t addr, uint8_t value)
+{
+    uint8_t& reg = _regs[addr];
+    const bool operating = _regs[static_cast<uint8_t>(Register::CNTL1)] & CNTL1_PC1;
+
+    switch (static_cast<Register>(addr))
+    {
+        case Register::CNTL1:
+            if (operating && (value & CNTL1_PC1))
+            {
+                // settings only change in stand-by
+                if (value != reg)
+                {
+                    ++_ignoredWrites;
+                }
+                return;
+            }
+            if (!operating && (value & CNTL1_PC1))
+            {
+                _operatingSinceNs = _nowNs;
+                _samplesSinceOperating = 0;
+            }
+            reg = value;
+            return;
+
+        case Register::CNTL2:
+            if (value & (1 << 7))
+            {
+                powerOn(); // SRST
+                return;
+            }
+            if (value & (1 << 6))
+            {
+                _regs[static_cast<uint8_t>(Register::COTR)] = 0xAA; // COTC
+            }
+            if (operating)
+            {
+                if ((value & ~CNTL2_COMMANDS) != (reg & ~CNTL2_COMMANDS))
+                {
+                    ++_ignoredWrites;
+                }
+                return;
+            }
+            reg = value & ~CNTL2_COMMANDS;
+            return;
+
+        case Register::CNTL5:
+            // manual wake/sleep commands are accepted while operating
+            reg = value;
+            return;
+
+        case Register::BUF_CLEAR:
+            _bufferCount = 0;
+            _bufferByteOffset = 0;
+            _triggered = false;
+            updateBufferStatus();
+            return;
+
+        case Register::BUF_STATUS_1:
+        case Register::BUF_STATUS_2:
+        case Register::BUF_READ:
+            return; // read-only
+
+        default:
+            break;
+    }
+
+    if (addr < static_cast<uint8_t>(Register::CNTL1)
+        || addr > static_cast<uint8_t>(Register::ADP_CNTL19))
+    {
+        return; // read-only or internal
+    }
+
+    if (operating)
+    {
+        if (value != reg)
+        {
+            ++_ignoredWrites;
+        }
+        return;
+    }
+
+    const bool resolutionChanged = addr == static_cast<uint8_t>(Register::BUF_CNTL2)
+        && ((value ^ reg) & BUF_CNTL2_BRES);
+
+    reg = value;
+
+    if (resolutionChanged)
+    {
+        _bufferCount = 0;
+        _bufferByteOffset = 0;
+    }
+    if (addr == static_cast<uint8_t>(Register::BUF_CNTL1)
+        || addr == static_cast<uint8_t>(Register::BUF_CNTL2))
+    {
+        updateBufferStatus();
+    }
+}
+
+void KX134Sim::elapse(uint64_t ns)
+{
+    const uint64_t endNs = _nowNs + ns;
+
+    if (!(_regs[static_cast<uint8_t>(Register::CNTL1)] & CNTL1_PC1))
+    {
+        _nowNs = endNs;
+        return;
+    }
+
+    const uint8_t osa = _regs[static_cast<uint8_t>(Register::ODCNTL)] & ODCNTL_OSA;
+
+    while (true)
+    {
+        // computed from the start of operation, so periods that are not a whole number of
+        // nanoseconds do not drift
+        uint64_t next
+            = _operatingSinceNs + (((_samplesSinceOperating + 1) * SIM_BASE_PERIOD_NS) >> osa);
+        if (next > endNs)
+        {
+            break;
+        }
+
+        // interrupts raised by the sample see the time it was taken
+        _nowNs = next;
+        ++_samplesSinceOperating;
+        generateSample(next);
+    }
+
+    _nowNs = endNs;
+}
+
+void KX134Sim::generateSample(uint64_t timeNs)
+{
+    int16_t sample[3];
+    _signalSource(timeNs, rangeG(), sample);
+
+    for (size_t axis = 0; axis < 3; ++axis)
+    {
+        uint16_t word = static_cast<uint16_t>(sample[axis]);
+        _regs[static_cast<uint8_t>(Register::XOUT_L) + 2 * axis] = word & 0xFF;
+        _regs[static_cast<uint8_t>(Register::XOUT_H) + 2 * axis] = word >> 8;
+    }
+
+    const uint8_t bufCntl2 = _regs[static_cast<uint8_t>(Register::BUF_CNTL2)];
+    if (bufCntl2 & BUF_CNTL2_BUFE)
+    {
+        const size_t capacity = bufferCapacity();
+        const size_t threshold = _regs[static_cast<uint8_t>(Register::BUF_CNTL1)];
+        bool store = true;
+        bool dropOldest = false;
+
+        switch (static_cast<BufferMode>(bufCntl2 & BUF_CNTL2_BM))
+        {
+            case BufferMode::FIFO:
+                store = _bufferCount < capacity;
+                break;
+            case BufferMode::STREAM:
+                dropOldest = _bufferCount == capacity;
+                break;
+            case BufferMode::TRIGGER:
+                // before the trigger, only the last SMP_TH samples are kept
+                if (_triggered)
+                {
+                    store = _bufferCount < capacity;
+                }
+                else
+                {
+                    dropOldest = _bufferCount >= (threshold > 0 ? threshold : 1);
+                }
+                break;
+        }
+
+        if (dropOldest && _bufferCount > 0)
+        {
+            _bufferHead = (_bufferHead + 1) % SIM_BUFFER_SAMPLES;
+            _bufferByteOffset = 0;
+            --_bufferCount;
+        }
+
+        if (store)
+        {
+            memcpy(_buffer[(_bufferHead + _bufferCount) % SIM_BUFFER_SAMPLES], sample, sizeof(sample));
+            ++_bufferCount;
+        }
+
+        updateBufferStatus();
+    }
+
+    if (_regs[static_cast<uint8_t>(Register::CNTL1)] & CNTL1_DRDYE)
+    {
+        raise(INT_DATA_READY);
+    }
+}
+
+uint8_t KX134Sim::rangeG() const
+{
+    return 8 << ((_regs[static_cast<uint8_t>(Register::CNTL1)] & CNTL1_GSEL) >> 3);
+}
+
+size_t KX134Sim::bufferBytesPerSample() const
+{
+    return _regs[static_cast<uint8_t>(Register::BUF_CNTL2)] & BUF_CNTL2_BRES
+        ? BUFFER_BYTES_PER_SAMPLE
+        : BUFFER_BYTES_PER_SAMPLE_8BIT;
+}
+
+size_t KX134Sim::bufferCapacity() const
+{
+    return _regs[static_cast<uint8_t>(Register::BUF_CNTL2)] & BUF_CNTL2_BRES
+        ? BUFFER_MAX_SAMPLES_16BIT
+        : BUFFER_MAX_SAMPLES;
+}
+
+void KX134Sim::updateBufferStatus()
+{
+    const size_t level = _bufferCount * bufferBytesPerSample() - _bufferByteOffset;
+    const size_t threshold = _regs[static_cast<uint8_t>(Register::BUF_CNTL1)];
+
+    _regs[static_cast<uint8_t>(Register::BUF_STATUS_1)] = level & 0xFF;
+    _regs[static_cast<uint8_t>(Register::BUF_STATUS_2)]
+        = (_triggered ? (1 << 7) : 0) | ((level >> 8) & 0b11);
+
+    uint8_t& ins2 = _regs[static_cast<uint8_t>(Register::INS2)];
+    uint8_t raised = 0;
+
+    if (threshold > 0 && _bufferCount >= threshold)
+    {
+        raised |= INT_WATERMARK;
+    }
+    else
+    {
+        ins2 &= ~INT_WATERMARK;
+    }
+
+    if (_bufferCount == bufferCapacity()
+        && (_regs[static_cast<uint8_t>(Register::BUF_CNTL2)] & BUF_CNTL2_BFIE))
+    {
+        raised |= INT_BUFFER_FULL;
+    }
+    else
+    {
+        ins2 &= ~INT_BUFFER_FULL;
+    }
+
+    if (raised != 0)
+    {
+        raise(raised);
+    }
+}
+
+void KX134Sim::raise(uint8_t bits)
+{
+    uint8_t& ins2 = _regs[static_cast<uint8_t>(Register::INS2)];
+    const uint8_t rising = bits & ~ins2;
+    ins2 |= bits;
+
+    if (_regs[static_cast<uint8_t>(Register::INC1)] & INC_IEN
+        && _regs[static_cast<uint8_t>(Register::INC4)] & rising)
+    {
+        handleInterrupt(InterruptPin::INT1);
+    }
+    if (_regs[static_cast<uint8_t>(Register::INC5)] & INC_IEN
+        && _regs[static_cast<uint8_t>(Register::INC6)] & rising)
+    {
+        handleInterrupt(InterruptPin::INT2);
+    }
+}
+
+void KX134Sim::restSignal(uint64_t timeNs, uint8_t rangeG, int16_t* output)
+{
+    (void)timeNs;
+
+    for (size_t axis = 0; axis < 3; ++axis)
+    {
+        // a few LSB of noise from a linear congruential generator
+        _noiseState = _noiseState * 1664525 + 1013904223;
+        output[axis] = static_cast<int16_t>(_noiseState >> 28) - 8;
+    }
+
+    output[2] += 32768 / rangeG;
+}
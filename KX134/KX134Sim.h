@@ -0,0 +1,238 @@
+#ifndef KX134SIM_H
+#define KX134SIM_H
+
+#include "KX134Base.h"
+
+/**
+ * @brief Simulated KX134, implementing the driver's transport against a register model
+ *
+ * Models the parts of the register map the driver relies on:
+ * - WHO_AM_I, COTR and the COTC command
+ * - software reset (SRST) restoring the power-on register values
+ * - PC1 semantics: settings written while operating (PC1 = 1) are ignored and counted
+ * - auto-incrementing burst reads and writes
+ * - ODR-paced sample generation into XOUT..ZOUT and the data-ready (DRDY) status
+ * - the sample buffer (FIFO, Stream and Trigger modes, 8 and 16-bit resolution) behind
+ *   BUF_STATUS, BUF_CLEAR and BUF_READ
+ * - the watermark, buffer full (if BFIE is set) and data-ready interrupts, routed by INC1/INC4 and
+ *   INC5/INC6 and delivered by calling handleInterrupt()
+ *
+ * Time is simulated: each bus transaction advances the clock by the time it would take on the
+ * bus, and advance() lets time pass without bus traffic. The simulation is deterministic.
+ */
+class KX134Sim : public KX134Base
+{
+public:
+    /**
+     * @brief Function generating the simulated acceleration
+     *
+     * Receives the simulated time in nanoseconds and the full-scale range in g, and writes the X,
+     * Y and Z accelerations in LSB.
+     */
+    typedef Callback<void(uint64_t, uint8_t, int16_t*)> SignalSource;
+
+    /**
+     * @brief Construct a new simulated KX134 at power-on
+     */
+    KX134Sim();
+
+    /**
+     * @brief Sets the modeled bus timing
+     *
+     * The defaults model SPI at 1MHz.
+     *
+     * @param[in] nsPerByte The time in nanoseconds to transfer one byte
+     * @param[in] nsPerTransaction The fixed time in nanoseconds added to every transaction
+     */
+    void setBusTiming(uint32_t nsPerByte, uint32_t nsPerTransaction);
+
+    /**
+     * @brief Sets the function generating the simulated acceleration
+     *
+     * By default, the sensor is at rest with 1g on Z and a few LSB of deterministic noise.
+     *
+     * @param[in] source The function to use, or nullptr to restore the default
+     */
+    void setSignalSource(SignalSource source);
+
+    /**
+     * @brief Lets simulated time pass without bus traffic
+     *
+     * @param[in] duration The time to advance by
+     */
+    void advance(std::chrono::microseconds duration);
+
+    /**
+     * @brief Returns the simulated time
+     *
+     * @return The time in nanoseconds since construction
+     */
+    uint64_t now() const;
+
+    /**
+     * @brief Raises the buffer trigger event used by the Trigger buffer mode
+     *
+     * @param[in] sources The InterruptSource bits of the engine event causing the trigger, raised
+     * on the pins they are routed to. Only INT_TILT and INT_TAP (as a single tap) are modeled.
+     */
+    void trigger(uint8_t sources = 0);
+
+    /**
+     * @brief Returns the number of register writes ignored because the KX134 was operating
+     *
+     * @return The number of ignored writes since construction
+     */
+    uint32_t ignoredWrites() const;
+
+protected:
+    /**
+     * @brief Reads a given register a given number of bytes
+     *
+     * @param[in] addr The register to read from
+     * @param[out] rx_buf The buffer to read into
+     * @param[in] size The number of bytes to read
+     */
+    virtual void readRegister(Register addr, char* rx_buf, int size = 1) override;
+
+    /**
+     * @brief Writes data to a given register
+     *
+     * @param[in] addr The register to write to
+     * @param[in] data The data to write
+     * @param[out] rx_buf The response to receive
+     * @param[in] size The number of bytes to write.
+     */
+    virtual void writeRegister(Register addr, char* data, char* rx_buf = nullptr, int size = 1) override;
+
+    /**
+     * @brief Returns the simulated time
+     *
+     * @return The simulated time in microseconds, wrapping around
+     */
+    virtual uint32_t timeUs() override;
+
+private:
+    /**
+     * @brief Restores the power-on register values and empties the buffer
+     */
+    void powerOn();
+
+    /**
+     * @brief Reads one register, applying its read side effects
+     *
+     * @param[in] addr The register address
+     * @return The register value
+     */
+    uint8_t readOne(uint8_t addr);
+
+    /**
+     * @brief Writes one register, applying its write side effects
+     *
+     * @param[in] addr The register address
+     * @param[in] value The value to write
+     */
+    void writeOne(uint8_t addr, uint8_t value);
+
+    /**
+     * @brief Advances the simulated clock, generating the samples that became due
+     *
+     * @param[in] ns The time to advance by in nanoseconds
+     */
+    void elapse(uint64_t ns);
+
+    /**
+     * @brief Produces one sample: updates the outputs, the buffer and the interrupt status
+     *
+     * @param[in] timeNs The simulated time the sample is taken at
+     */
+    void generateSample(uint64_t timeNs);
+
+    /**
+     * @brief Returns the full-scale range in g selected by GSEL
+     *
+     * @return 8, 16, 32 or 64
+     */
+    uint8_t rangeG() const;
+
+    /**
+     * @brief Returns the number of bytes one buffered sample occupies
+     *
+     * @return 6 for 16-bit samples, 3 for 8-bit samples
+     */
+    size_t bufferBytesPerSample() const;
+
+    /**
+     * @brief Returns the number of samples the buffer holds at the current resolution
+     *
+     * @return 86 for 16-bit samples, 171 for 8-bit samples
+     */
+    size_t bufferCapacity() const;
+
+    /**
+     * @brief Updates BUF_STATUS and the buffer interrupt status after the buffer changed
+     */
+    void updateBufferStatus();
+
+    /**
+     * @brief Sets status bits in INS2 and fires the interrupt pins they are routed to
+     *
+     * @param[in] bits The InterruptSource bits that were raised
+     */
+    void raise(uint8_t bits);
+
+    /**
+     * @brief Default signal: at rest with 1g on Z and deterministic noise
+     *
+     * @param[in] timeNs The simulated time the sample is taken at
+     * @param[in] rangeG The full-scale range in g
+     * @param[out] output The X, Y and Z accelerations in LSB
+     */
+    void restSignal(uint64_t timeNs, uint8_t rangeG, int16_t* output);
+
+    /** @brief The most samples the buffer can hold (8-bit resolution) */
+    static constexpr size_t SIM_BUFFER_SAMPLES = 171;
+
+    /** @brief The register file */
+    uint8_t _regs[128];
+
+    /** @brief Buffered samples, as a ring */
+    int16_t _buffer[SIM_BUFFER_SAMPLES][3];
+
+    /** @brief Index of the oldest buffered sample */
+    size_t _bufferHead;
+
+    /** @brief Number of buffered samples */
+    size_t _bufferCount;
+
+    /** @brief Bytes of the oldest sample already read through BUF_READ */
+    size_t _bufferByteOffset;
+
+    /** @brief Whether the trigger event has occurred in Trigger mode */
+    bool _triggered;
+
+    /** @brief Simulated time in nanoseconds */
+    uint64_t _nowNs;
+
+    /** @brief Simulated time at which PC1 was set */
+    uint64_t _operatingSinceNs;
+
+    /** @brief Number of samples produced since PC1 was set */
+    uint64_t _samplesSinceOperating;
+
+    /** @brief Modeled time to transfer one byte */
+    uint32_t _nsPerByte;
+
+    /** @brief Modeled fixed time per transaction */
+    uint32_t _nsPerTransaction;
+
+    /** @brief State of the noise generator */
+    uint32_t _noiseState;
+
+    /** @brief Number of writes ignored because the KX134 was operating */
+    uint32_t _ignoredWrites;
+
+    /** @brief The function generating the simulated acceleration */
+    SignalSource _signalSource;
+};
+
+#endif
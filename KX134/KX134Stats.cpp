@@ -0,0 +1,145 @@
+#include "KX134Stats.h"
+
+#include <cmath>
+
+KX134Stats::KX134Stats(size_t windowSamples, Window window, float gravsPerLsb)
+    : _windowSamples(windowSamples)
+    , _window(window)
+    , _alpha(windowSamples > 0 ? 2.0f / (windowSamples + 1) : 1.0f)
+    , _gravsPerLsb(gravsPerLsb)
+{
+    reset();
+}
+
+void KX134Stats::setScale(float gravsPerLsb) { _gravsPerLsb = gravsPerLsb; }
+
+void KX134Stats::reset()
+{
+    clearAccumulators();
+    _complete[0] = _complete[1] = _complete[2] = _running[0];
+    _completeCount = 0;
+    _windowCount = 0;
+}
+
+size_t KX134Stats::add(const int16_t* samples, size_t count)
+{
+    size_t completed = 0;
+
+    for (size_t sample = 0; sample < count; ++sample, samples += 3)
+    {
+        ++_runningCount;
+
+        if (_window == Window::EXPONENTIAL)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                Accumulator& acc = _running[axis];
+                float x = samples[axis];
+
+                if (_runningCount == 1)
+                {
+                    acc = { x, 0.0f, x * x, x, x };
+                    continue;
+                }
+
+                // exponentially weighted mean and variance (West, 1979)
+                float delta = x - acc.mean;
+                acc.mean += _alpha * delta;
+                acc.m2 = (1.0f - _alpha) * (acc.m2 + _alpha * delta * delta);
+                acc.meanSquare += _alpha * (x * x - acc.meanSquare);
+
+                // peak followers decaying towards the mean
+                acc.max = x > acc.max ? x : acc.max - _alpha * (acc.max - acc.mean);
+                acc.min = x < acc.min ? x : acc.min - _alpha * (acc.min - acc.mean);
+            }
+            continue;
+        }
+
+        float weight = 1.0f / _runningCount;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            Accumulator& acc = _running[axis];
+            float x = samples[axis];
+
+            // Welford's update
+            float delta = x - acc.mean;
+            acc.mean += delta * weight;
+            acc.m2 += delta * (x - acc.mean);
+            acc.meanSquare += (x * x - acc.meanSquare) * weight;
+            acc.min = x < acc.min ? x : acc.min;
+            acc.max = x > acc.max ? x : acc.max;
+        }
+
+        if (_runningCount == _windowSamples)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                _complete[axis] = _running[axis];
+            }
+            _completeCount = _runningCount;
+            ++_windowCount;
+            ++completed;
+
+            clearAccumulators();
+        }
+    }
+
+    return completed;
+}
+
+size_t KX134Stats::getStats(AxisStats* output) const
+{
+    if (_window == Window::TUMBLING && _windowSamples != 0)
+    {
+        computeStats(_complete, _completeCount, output);
+        return _completeCount;
+    }
+
+    computeStats(_running, _runningCount, output);
+    return _runningCount;
+}
+
+uint32_t KX134Stats::windowCount() const { return _windowCount; }
+
+void KX134Stats::clearAccumulators()
+{
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        _running[axis] = { 0.0f, 0.0f, 0.0f, INFINITY, -INFINITY };
+    }
+    _runningCount = 0;
+}
+
+void KX134Stats::computeStats(const Accumulator* accumulators, size_t count, AxisStats* output) const
+{
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const Accumulator& acc = accumulators[axis];
+        AxisStats& stats = output[axis];
+
+        if (count == 0)
+        {
+            stats = {};
+            continue;
+        }
+
+        float variance = acc.m2;
+        if (_window == Window::TUMBLING)
+        {
+            // sample variance
+            variance = count > 1 ? acc.m2 / (count - 1) : 0.0f;
+        }
+
+        float rms = std::sqrt(acc.meanSquare);
+        float peak = std::fmax(std::fabs(acc.min), std::fabs(acc.max));
+
+        stats.mean = acc.mean * _gravsPerLsb;
+        stats.variance = variance * _gravsPerLsb * _gravsPerLsb;
+        stats.stdDev = std::sqrt(variance) * _gravsPerLsb;
+        stats.rms = rms * _gravsPerLsb;
+        stats.min = acc.min * _gravsPerLsb;
+        stats.max = acc.max * _gravsPerLsb;
+        stats.peakToPeak = (acc.max - acc.min) * _gravsPerLsb;
+        stats.crestFactor = rms > 0.0f ? peak / rms : 0.0f;
+    }
+}
@@ -0,0 +1,157 @@
+#ifndef KX134STATS_H
+#define KX134STATS_H
+
+#include "mbed.h"
+
+/**
+ * @brief Streaming per-axis statistics over KX134 samples
+ *
+ * Samples are consumed as they arrive, singly or as whole blocks returned by readBuffer(), and
+ * only a few accumulators per axis are kept, so memory use does not depend on the window length.
+ *
+ * Two kinds of window are supported:
+ * - TUMBLING: consecutive non-overlapping windows of a fixed number of samples. Mean and variance
+ *   use Welford's algorithm. The results of the last complete window are kept until the next one
+ *   completes.
+ * - EXPONENTIAL: a sliding window in which each sample's weight decays exponentially, with the
+ *   same mean age as a window of the given length. Min and max follow the peaks and decay back
+ *   towards the mean at the same rate.
+ */
+class KX134Stats
+{
+public:
+    /**
+     * @brief The kinds of window
+     */
+    enum class Window
+    {
+        TUMBLING,
+        EXPONENTIAL
+    };
+
+    /**
+     * @brief Statistics of one axis, in gravs (or LSB if the scale is 1)
+     */
+    struct AxisStats
+    {
+        float mean;
+        float variance;
+        float stdDev;
+        float rms;
+        float min;
+        float max;
+        float peakToPeak;
+
+        /** @brief Peak absolute value divided by the RMS */
+        float crestFactor;
+    };
+
+    /**
+     * @brief Construct a new KX134Stats
+     *
+     * @param[in] windowSamples The window length in samples. A tumbling window of 0 samples never
+     * completes, accumulating over all samples added.
+     * @param[in] window The kind of window
+     * @param[in] gravsPerLsb The scale applied to the results, e.g. getGravsPerLsb()
+     */
+    KX134Stats(size_t windowSamples, Window window = Window::TUMBLING, float gravsPerLsb = 1.0f);
+
+    /**
+     * @brief Sets the scale applied to the results
+     *
+     * @param[in] gravsPerLsb The value of 1 LSB in gravs, or 1 to get results in LSB
+     */
+    void setScale(float gravsPerLsb);
+
+    /**
+     * @brief Discards all samples and results
+     */
+    void reset();
+
+    /**
+     * @brief Adds samples
+     *
+     * @param[in] samples The samples in LSB, as consecutive X, Y, Z triples, e.g. a block returned
+     * by readBuffer()
+     * @param[in] count The number of samples
+     * @return The number of tumbling windows completed by these samples
+     */
+    size_t add(const int16_t* samples, size_t count = 1);
+
+    /**
+     * @brief Returns the statistics
+     *
+     * For a tumbling window of non-zero length, these are the statistics of the last complete
+     * window. Otherwise, they cover the samples added so far.
+     *
+     * @param[out] output The X, Y and Z statistics
+     * @return The number of samples the statistics cover
+     */
+    size_t getStats(AxisStats* output) const;
+
+    /**
+     * @brief Returns the number of tumbling windows completed since construction or reset()
+     *
+     * @return The number of complete windows
+     */
+    uint32_t windowCount() const;
+
+private:
+    /**
+     * @brief The running state of one axis, in LSB
+     */
+    struct Accumulator
+    {
+        float mean;
+
+        /** @brief Sum of squared deviations from the mean (tumbling) or variance (exponential) */
+        float m2;
+
+        float meanSquare;
+        float min;
+        float max;
+    };
+
+    /**
+     * @brief Empties the running accumulators
+     */
+    void clearAccumulators();
+
+    /**
+     * @brief Computes the statistics of accumulators
+     *
+     * @param[in] accumulators The X, Y and Z accumulators
+     * @param[in] count The number of samples accumulated
+     * @param[out] output The X, Y and Z statistics
+     */
+    void computeStats(const Accumulator* accumulators, size_t count, AxisStats* output) const;
+
+    /** @brief The window length in samples */
+    size_t _windowSamples;
+
+    /** @brief The kind of window */
+    Window _window;
+
+    /** @brief Weight of a new sample in an exponential window */
+    float _alpha;
+
+    /** @brief The scale applied to the results */
+    float _gravsPerLsb;
+
+    /** @brief The running accumulators */
+    Accumulator _running[3];
+
+    /** @brief The number of samples in the running accumulators */
+    size_t _runningCount;
+
+    /** @brief The accumulators of the last complete tumbling window */
+    Accumulator _complete[3];
+
+    /** @brief The number of samples in the last complete tumbling window */
+    size_t _completeCount;
+
+    /** @brief The number of tumbling windows completed */
+    uint32_t _windowCount;
+};
+
+#endif
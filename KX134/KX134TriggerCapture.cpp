@@ -0,0 +1,128 @@
+#include "KX134TriggerCapture.h"
+
+KX134TriggerCapture::KX134TriggerCapture(KX134Base& accel, EventQueue& queue)
+    : _accel(accel)
+    , _queue(queue)
+    , _pin(KX134Base::InterruptPin::INT1)
+    , _armed(false)
+    , _interrupts(0)
+    , _triggerTimeUs(0)
+    , _armTimeUs(0)
+    , _preTrigger(0)
+    , _captureCount(0)
+{
+}
+
+void KX134TriggerCapture::arm(KX134Base::InterruptPin pin, PinName mcuPin,
+    uint8_t triggerSources, uint8_t preTrigger, CaptureCallback onCapture,
+    KX134Base::BufferResolution resolution)
+{
+    disarm();
+
+    _pin = pin;
+    _onCapture = onCapture;
+
+    _accel.applyConfig(KX134Base::Config()
+                           .buffer(KX134Base::BufferMode::TRIGGER, preTrigger, resolution)
+                           .bufferFullInterrupt(true));
+    _preTrigger = preTrigger < _accel.getBufferCapacity() ? preTrigger : _accel.getBufferCapacity();
+
+    // the watermark would fire before the trigger, so only the trigger and buffer full are routed
+    _accel.attachInterruptCallback(callback(this, &KX134TriggerCapture::onInterrupt));
+    _accel.enableInterrupt(pin, mcuPin, triggerSources | KX134Base::INT_BUFFER_FULL);
+
+    _armed = true;
+    rearm();
+}
+
+void KX134TriggerCapture::disarm()
+{
+    if (!_armed)
+    {
+        return;
+    }
+
+    _armed = false;
+    _accel.disableInterrupt(_pin);
+    _accel.attachInterruptCallback(nullptr);
+    _accel.applyConfig(KX134Base::Config().noBuffer().bufferFullInterrupt(false));
+}
+
+bool KX134TriggerCapture::armed() const { return _armed; }
+
+uint32_t KX134TriggerCapture::captureCount() const { return _captureCount; }
+
+void KX134TriggerCapture::onInterrupt(KX134Base::InterruptPin pin)
+{
+    if (_interrupts++ == 0)
+    {
+        _triggerTimeUs = _accel.getInterruptTimeUs(pin);
+    }
+
+    _queue.call(this, &KX134TriggerCapture::process);
+}
+
+void KX134TriggerCapture::process()
+{
+    if (!_armed || _interrupts == 0)
+    {
+        return;
+    }
+
+    // further trigger events may interrupt before the buffer is full
+    size_t count = _accel.getBufferSampleCount();
+    if (count < _accel.getBufferCapacity() || !_accel.bufferTriggered())
+    {
+        _accel.clearInterrupts();
+        return;
+    }
+
+    const uint32_t fullTimeUs = _accel.getInterruptTimeUs(_pin);
+    count = _accel.readBuffer(_samples, KX134Base::BUFFER_MAX_SAMPLES);
+
+    // the newest sample filled the buffer, and samples since the trigger are one period apart.
+    // The drift measured by the sample clock corrects the nominal rate, if it has been anchored.
+    const float nominalHz = KX134Base::outputDataRateToHz(
+        static_cast<KX134Base::OutputDataRate>(_accel.getOutputDataRateBytes()));
+    const float periodUs
+        = 1000000.0f / (nominalHz * (1.0f + _accel.getSampleClock().getDriftPpm() * 1e-6f));
+
+    // before the trigger, the buffer keeps the last _preTrigger samples. If it was cleared more
+    // than that (and a sample of margin) before the trigger, it held all of them, and the
+    // trigger is right after them. Otherwise, the interrupt times tell how many it held.
+    size_t triggerIndex = _preTrigger;
+    if (static_cast<float>(_triggerTimeUs - _armTimeUs) < (_preTrigger + 1) * periodUs)
+    {
+        const size_t postTrigger
+            = static_cast<size_t>(static_cast<float>(fullTimeUs - _triggerTimeUs) / periodUs + 0.5f)
+            + 1;
+        triggerIndex = postTrigger < count ? count - postTrigger : 0;
+        triggerIndex = triggerIndex < _preTrigger ? triggerIndex : _preTrigger;
+    }
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        const float age = static_cast<float>(count - 1 - i) * periodUs;
+        _frames[i] = { fullTimeUs - static_cast<uint32_t>(age + 0.5f),
+            _samples[3 * i],
+            _samples[3 * i + 1],
+            _samples[3 * i + 2] };
+    }
+
+    ++_captureCount;
+    if (_onCapture)
+    {
+        _onCapture(_frames, count, triggerIndex);
+    }
+
+    rearm();
+}
+
+void KX134TriggerCapture::rearm()
+{
+    // clearing the buffer also resets the trigger
+    _accel.clearBuffer();
+    _accel.clearInterrupts();
+    _armTimeUs = _accel.getTimeUs();
+    _interrupts = 0;
+}
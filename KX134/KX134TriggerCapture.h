@@ -0,0 +1,143 @@
+#ifndef KX134TRIGGERCAPTURE_H
+#define KX134TRIGGERCAPTURE_H
+
+#include "mbed.h"
+#include "KX134Base.h"
+#include "KX134Frame.h"
+
+/**
+ * @brief Captures a window of samples around an engine event, using the buffer Trigger mode
+ *
+ * While armed, the KX134 keeps the last pre-trigger samples in its buffer, without interrupting
+ * the MCU. An engine event (e.g. a tap or wake-up) routed to the interrupt pin triggers the
+ * buffer, which then fills up with post-trigger samples. Once full, the whole buffer is read as
+ * one block, delivered with the index of the trigger, and the capture re-arms.
+ *
+ * If the buffer had time to fill with the pre-trigger samples before the trigger event, the
+ * trigger index is exactly the pre-trigger count. Otherwise, it is estimated from the interrupt
+ * times, which interrupt latency and the engine's detection delay can shift by a sample or so.
+ *
+ * The engines are configured separately, e.g.
+ * @code
+ * accel.applyConfig(KX134Base::Config()
+ *                       .outputDataRate(KX134Base::OutputDataRate::ODR_25600HZ)
+ *                       .tap(KX134Base::TapRate::TAP_1600HZ));
+ * capture.arm(KX134Base::InterruptPin::INT1, PIN_KX134_INT1, KX134Base::INT_TAP, 32,
+ *     callback(&handleShock));
+ * @endcode
+ *
+ * It takes over the KX134's interrupt callback (see KX134Base::attachInterruptCallback()) while
+ * armed.
+ */
+class KX134TriggerCapture
+{
+public:
+    /**
+     * @brief Function receiving a captured block. Called on the EventQueue.
+     *
+     * Receives the frames, their number, and the index of the frame the trigger event was
+     * detected at. The frames are valid until the function returns.
+     */
+    typedef Callback<void(const KX134Frame*, size_t, size_t)> CaptureCallback;
+
+    /**
+     * @brief Construct a new KX134TriggerCapture
+     *
+     * @param[in] accel The initialized KX134
+     * @param[in] queue The EventQueue to read and deliver blocks on
+     */
+    KX134TriggerCapture(KX134Base& accel, EventQueue& queue);
+
+    /**
+     * @brief Enables the buffer in Trigger mode and waits for a trigger event
+     *
+     * @param[in] pin The KX134 interrupt pin to use
+     * @param[in] mcuPin The MCU pin the KX134 interrupt pin is connected to
+     * @param[in] triggerSources The InterruptSource bits that trigger the buffer, e.g. INT_TAP
+     * @param[in] preTrigger The number of samples to keep from before the trigger. Clamped to
+     * the buffer capacity.
+     * @param[in] onCapture The function to deliver captured blocks to
+     * @param[in] resolution The BufferResolution to store samples at
+     */
+    void arm(KX134Base::InterruptPin pin, PinName mcuPin, uint8_t triggerSources,
+        uint8_t preTrigger, CaptureCallback onCapture,
+        KX134Base::BufferResolution resolution = KX134Base::BufferResolution::RES_16BIT);
+
+    /**
+     * @brief Stops capturing and disables the buffer
+     */
+    void disarm();
+
+    /**
+     * @brief Returns if the capture is armed
+     *
+     * @return true if armed, false otherwise
+     */
+    bool armed() const;
+
+    /**
+     * @brief Returns the number of blocks captured
+     *
+     * @return The number of blocks delivered since construction
+     */
+    uint32_t captureCount() const;
+
+private:
+    /**
+     * @brief Interrupt callback, records the trigger time and posts process() to the EventQueue
+     *
+     * @param[in] pin The KX134 interrupt pin that fired
+     */
+    void onInterrupt(KX134Base::InterruptPin pin);
+
+    /**
+     * @brief Reads and delivers the block once the buffer is full. Runs on the EventQueue.
+     */
+    void process();
+
+    /**
+     * @brief Empties the buffer and waits for the next trigger event
+     *
+     * The interrupt count is reset last, so interrupts from before the buffer was cleared are
+     * not taken for the trigger.
+     */
+    void rearm();
+
+    /** @brief The KX134 */
+    KX134Base& _accel;
+
+    /** @brief The EventQueue blocks are read and delivered on */
+    EventQueue& _queue;
+
+    /** @brief The interrupt pin in use */
+    KX134Base::InterruptPin _pin;
+
+    /** @brief The function to deliver blocks to */
+    CaptureCallback _onCapture;
+
+    /** @brief Whether the capture is armed */
+    volatile bool _armed;
+
+    /** @brief Interrupts since the capture was (re-)armed; the first one is the trigger */
+    volatile uint32_t _interrupts;
+
+    /** @brief MCU time of the trigger interrupt in microseconds */
+    volatile uint32_t _triggerTimeUs;
+
+    /** @brief MCU time the buffer was last cleared in microseconds */
+    uint32_t _armTimeUs;
+
+    /** @brief The number of samples kept from before the trigger (SMP_TH) */
+    size_t _preTrigger;
+
+    /** @brief The number of blocks captured */
+    uint32_t _captureCount;
+
+    /** @brief Raw samples of the block being read */
+    int16_t _samples[KX134Base::BUFFER_MAX_SAMPLES * 3];
+
+    /** @brief Frames of the block being delivered */
+    KX134Frame _frames[KX134Base::BUFFER_MAX_SAMPLES];
+};
+
+#endif
@@ -0,0 +1,140 @@
+//
+// Throughput and latency benchmarks for the KX134 driver
+//
+
+#include <cinttypes>
+
+#include "KX134Benchmark.h"
+#include "KX134.h"
+#include "KX134I2C.h"
+#include "KX134SPI.h"
+#include "KX134Sim.h"
+#include "mbed.h"
+
+uint32_t KX134Benchmark::_latencies[BENCH_CALLS];
+
+KX134Benchmark::KX134Benchmark(
+    const char* transport, KX134Base& accel, Callback<void()> waitForSamples)
+    : _transport(transport)
+    , _accel(accel)
+    , _waitForSamples(waitForSamples)
+{
+}
+
+void KX134Benchmark::print_header()
+{
+    printf("transport,operation,calls,samples_per_s,bus_bytes_per_sample,p50_us,p99_us,max_us\r\n");
+}
+
+void KX134Benchmark::bench_buffer_drain(
+    const char* operation, KX134Base::BufferResolution resolution)
+{
+    static int16_t samples[KX134Base::BUFFER_MAX_SAMPLES * 3];
+
+    _accel.applyConfig(KX134Base::Config()
+                           .outputDataRate(KX134Base::OutputDataRate::ODR_25600HZ)
+                           .buffer(KX134Base::BufferMode::STREAM, BENCH_WATERMARK, resolution));
+    _accel.clearBuffer();
+
+    run(operation,
+        BENCH_CALLS / 10,
+        [&]() { return _accel.readBuffer(samples, BENCH_WATERMARK); },
+        callback(this, &KX134Benchmark::wait_for_samples));
+
+    _accel.disableBuffer();
+}
+
+void KX134Benchmark::bench_config_change()
+{
+    size_t i = 0;
+    run("setAccelRange", BENCH_CALLS, [&]() {
+        _accel.setAccelRange(++i % 2 ? KX134Base::Range::RANGE_8G : KX134Base::Range::RANGE_64G);
+        return 0;
+    });
+}
+
+void KX134Benchmark::bench_reset()
+{
+    run("reset", BENCH_CALLS / 100, [&]() {
+        _accel.reset();
+        return 0;
+    });
+}
+
+void KX134Benchmark::wait_for_samples()
+{
+    if (_waitForSamples)
+    {
+        _waitForSamples();
+        return;
+    }
+
+    while (_accel.getBufferSampleCount() < BENCH_WATERMARK)
+        ;
+}
+
+/**
+ * @brief Runs all benchmarks against one KX134
+ */
+template <typename Accel>
+static void bench_all(const char* transport, Accel& accel, Callback<void()> waitForSamples)
+{
+    KX134Benchmark bench(transport, accel, waitForSamples);
+
+    bench.bench_get_accelerations("getAccelerations", static_cast<KX134Base&>(accel));
+    bench.bench_get_accelerations("getAccelerations_static", accel);
+    bench.bench_buffer_drain("readBuffer", KX134Base::BufferResolution::RES_16BIT);
+    bench.bench_buffer_drain("readBuffer_8bit", KX134Base::BufferResolution::RES_8BIT);
+    bench.bench_config_change();
+    bench.bench_reset();
+}
+
+#if HAMSTER_SIMULATOR != 1
+int main()
+#else
+int kx134_benchmark_main()
+#endif
+{
+    // the drivers, the latency array and the drain buffer are static: together they would
+    // overflow the default 4 KB main thread stack
+    KX134Benchmark::print_header();
+
+    {
+        static KX134<KX134Sim> sim;
+        if (sim.init())
+        {
+            // one watermark of samples at 25600Hz
+            bench_all("sim", sim, [&]() {
+                sim.advance(std::chrono::microseconds(BENCH_WATERMARK * 1000000 / 25600));
+            });
+        }
+    }
+
+    {
+        static KX134<KX134SPI> spi(
+            BENCH_PIN_SPI_MOSI, BENCH_PIN_SPI_MISO, BENCH_PIN_SPI_SCK, BENCH_PIN_SPI_CS);
+        if (spi.init())
+        {
+            bench_all("spi", spi, nullptr);
+        }
+        else
+        {
+            printf("# SPI KX134 not found, skipped\r\n");
+        }
+    }
+
+    if (BENCH_PIN_I2C_SDA != NC)
+    {
+        static KX134<KX134I2C> i2c(BENCH_PIN_I2C_SDA, BENCH_PIN_I2C_SCL, BENCH_I2C_ADDR);
+        if (i2c.init())
+        {
+            bench_all("i2c", i2c, nullptr);
+        }
+        else
+        {
+            printf("# I2C KX134 not found, skipped\r\n");
+        }
+    }
+
+    return 0;
+}
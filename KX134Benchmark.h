@@ -0,0 +1,159 @@
+//
+// Throughput and latency benchmarks for the KX134 driver
+//
+
+#ifndef KX134BENCHMARK_H
+#define KX134BENCHMARK_H
+
+#include <algorithm>
+
+#include "mbed.h"
+#include "KX134Base.h"
+
+#define BENCH_PIN_SPI_MOSI PB_5
+#define BENCH_PIN_SPI_MISO PB_4
+#define BENCH_PIN_SPI_SCK PB_3
+#define BENCH_PIN_SPI_CS PA_4
+
+/* Set to the I2C pins to also benchmark the I2C transport */
+#define BENCH_PIN_I2C_SDA NC
+#define BENCH_PIN_I2C_SCL NC
+#define BENCH_I2C_ADDR 0x1F
+
+/* Number of timed calls per benchmark */
+#define BENCH_CALLS 1000
+
+/* Watermark used by the buffer drain benchmark */
+#define BENCH_WATERMARK 32
+
+/**
+ * @brief Runs the benchmarks against one KX134 and prints one CSV row per benchmark
+ *
+ * Columns: transport, operation, calls, samples_per_s, bus_bytes_per_sample, p50_us, p99_us,
+ * max_us
+ */
+class KX134Benchmark
+{
+public:
+    /**
+     * @brief Construct a new KX134Benchmark
+     *
+     * @param[in] transport The transport name printed in each row
+     * @param[in] accel The initialized KX134 to benchmark
+     * @param[in] waitForSamples Called outside the timed region whenever the buffer drain
+     * benchmark needs a full watermark of samples. If nullptr, the buffer level is polled.
+     */
+    KX134Benchmark(const char* transport, KX134Base& accel, Callback<void()> waitForSamples);
+
+    /**
+     * @brief Prints the CSV header row
+     */
+    static void print_header();
+
+    /**
+     * @brief Benchmarks single sample reads
+     *
+     * Pass the KX134Base to measure the virtual call path, or the KX134<Transport> to measure the
+     * compile-time bound path.
+     *
+     * @param[in] operation The operation name printed in the row
+     * @param[in] accel The KX134 to read from, same as the one given to the constructor
+     */
+    template <typename Accel> void bench_get_accelerations(const char* operation, Accel& accel)
+    {
+        int16_t output[3];
+        run(operation, BENCH_CALLS, [&]() {
+            accel.getAccelerations(output);
+            return 1;
+        });
+    }
+
+    /**
+     * @brief Benchmarks draining the sample buffer, one watermark at a time
+     *
+     * @param[in] operation The name of the benchmark
+     * @param[in] resolution The BufferResolution to store samples at
+     */
+    void bench_buffer_drain(const char* operation, KX134Base::BufferResolution resolution);
+
+    /**
+     * @brief Benchmarks changing the acceleration range
+     */
+    void bench_config_change();
+
+    /**
+     * @brief Benchmarks software resets
+     */
+    void bench_reset();
+
+private:
+    /**
+     * @brief Times calls of a function and prints the results as a CSV row
+     *
+     * @param[in] operation The operation name printed in the row
+     * @param[in] calls The number of calls to time
+     * @param[in] call The function to time. Returns the number of samples it produced.
+     * @param[in] before Called before each call, outside the timed region
+     */
+    template <typename F> void run(const char* operation, size_t calls, F call,
+        Callback<void()> before = nullptr)
+    {
+        Timer timer;
+        // runs across all calls, so calls shorter than the timer resolution still add up
+        Timer total;
+        uint32_t samples = 0;
+        uint32_t bytes = 0;
+
+        for (size_t i = 0; i < calls; ++i)
+        {
+            if (before)
+            {
+                before();
+            }
+
+            KX134Base::BusStats start = _accel.getBusStats();
+
+            timer.reset();
+            total.start();
+            timer.start();
+            samples += call();
+            timer.stop();
+            total.stop();
+
+            bytes += _accel.getBusStats().bytes - start.bytes;
+            _latencies[i] = timer.elapsed_time().count();
+        }
+
+        std::sort(_latencies, _latencies + calls);
+
+        float seconds = std::chrono::duration<float>(total.elapsed_time()).count();
+        printf("%s,%s,%u,%.1f,%.2f,%" PRIu32 ",%" PRIu32 ",%" PRIu32 "\r\n",
+            _transport,
+            operation,
+            static_cast<unsigned>(calls),
+            seconds > 0 ? samples / seconds : 0.0f,
+            samples > 0 ? static_cast<float>(bytes) / samples : 0.0f,
+            _latencies[calls / 2],
+            _latencies[calls * 99 / 100],
+            _latencies[calls - 1]);
+    }
+
+    /**
+     * @brief Waits until a full watermark of samples is buffered
+     */
+    void wait_for_samples();
+
+    /** @brief The transport name printed in each row */
+    const char* _transport;
+
+    /** @brief The KX134 being benchmarked */
+    KX134Base& _accel;
+
+    /** @brief Called when the buffer drain benchmark needs samples */
+    Callback<void()> _waitForSamples;
+
+    /** @brief Per-call latencies in microseconds, static to keep them off the stack */
+    static uint32_t _latencies[BENCH_CALLS];
+};
+
+#endif
@@ -24,6 +24,10 @@ KX134I2C new_accel(PIN_I2C_SDA, PIN_I2C_SCL, 0x1F);
 
 KX134SPI new_accel(PIN_SPI_MOSI, PIN_SPI_MISO, PIN_SPI_SCK, PIN_SPI_CS);
 #endif
+
+/* Connect to the KX134 INT1 pin to wait on data-ready interrupts instead of polling */
+#define PIN_KX134_INT1 NC
+
 class KX134TestSuite
 {
 public:
@@ -31,6 +35,9 @@ public:
     void set_hz();
     void set_range();
     void test_stddev();
+    void test_transaction_rate();
+    void test_capture();
+    void test_adp();
 };
 
 #endif
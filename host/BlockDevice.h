@@ -0,0 +1,71 @@
+/**
+ * @file BlockDevice.h
+ * @brief Host shim of the Mbed OS BlockDevice interface
+ */
+
+#ifndef KX134_HOST_BLOCKDEVICE_H
+#define KX134_HOST_BLOCKDEVICE_H
+
+#include <cstdint>
+
+enum
+{
+    BD_ERROR_OK = 0,
+    BD_ERROR_DEVICE_ERROR = -4001,
+};
+
+namespace mbed
+{
+typedef uint64_t bd_addr_t;
+typedef uint64_t bd_size_t;
+
+/**
+ * @brief Storage read, programmed and erased in blocks
+ */
+class BlockDevice
+{
+public:
+    virtual ~BlockDevice() { }
+
+    virtual int init() = 0;
+
+    virtual int deinit() = 0;
+
+    virtual int sync() { return BD_ERROR_OK; }
+
+    virtual int read(void* buffer, bd_addr_t addr, bd_size_t size) = 0;
+
+    virtual int program(const void* buffer, bd_addr_t addr, bd_size_t size) = 0;
+
+    virtual int erase(bd_addr_t addr, bd_size_t size)
+    {
+        (void)addr;
+        (void)size;
+        return BD_ERROR_OK;
+    }
+
+    virtual bd_size_t get_read_size() const = 0;
+
+    virtual bd_size_t get_program_size() const = 0;
+
+    virtual bd_size_t get_erase_size() const { return get_program_size(); }
+
+    virtual bd_size_t get_erase_size(bd_addr_t addr) const
+    {
+        (void)addr;
+        return get_erase_size();
+    }
+
+    virtual int get_erase_value() const { return -1; }
+
+    virtual bd_size_t size() const = 0;
+
+    virtual const char* get_type() const = 0;
+};
+} // namespace mbed
+
+using mbed::bd_addr_t;
+using mbed::bd_size_t;
+using mbed::BlockDevice;
+
+#endif
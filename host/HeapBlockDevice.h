@@ -0,0 +1,106 @@
+/**
+ * @file HeapBlockDevice.h
+ * @brief Host shim of the Mbed OS HeapBlockDevice, a BlockDevice in RAM
+ */
+
+#ifndef KX134_HOST_HEAPBLOCKDEVICE_H
+#define KX134_HOST_HEAPBLOCKDEVICE_H
+
+#include <cstring>
+#include <vector>
+
+#include "BlockDevice.h"
+
+namespace mbed
+{
+/**
+ * @brief BlockDevice in RAM. Rejects unaligned or out of range operations, as on target.
+ */
+class HeapBlockDevice : public BlockDevice
+{
+public:
+    HeapBlockDevice(bd_size_t size, bd_size_t block = 512)
+        : HeapBlockDevice(size, block, block, block)
+    {
+    }
+
+    HeapBlockDevice(bd_size_t size, bd_size_t read, bd_size_t program, bd_size_t erase)
+        : _size(size)
+        , _readSize(read)
+        , _programSize(program)
+        , _eraseSize(erase)
+    {
+    }
+
+    virtual int init() override
+    {
+        _data.assign(_size, 0xFF);
+        return BD_ERROR_OK;
+    }
+
+    virtual int deinit() override
+    {
+        _data.clear();
+        return BD_ERROR_OK;
+    }
+
+    virtual int read(void* buffer, bd_addr_t addr, bd_size_t size) override
+    {
+        if (!valid(addr, size, _readSize))
+        {
+            return BD_ERROR_DEVICE_ERROR;
+        }
+
+        memcpy(buffer, &_data[addr], size);
+        return BD_ERROR_OK;
+    }
+
+    virtual int program(const void* buffer, bd_addr_t addr, bd_size_t size) override
+    {
+        if (!valid(addr, size, _programSize))
+        {
+            return BD_ERROR_DEVICE_ERROR;
+        }
+
+        memcpy(&_data[addr], buffer, size);
+        return BD_ERROR_OK;
+    }
+
+    virtual int erase(bd_addr_t addr, bd_size_t size) override
+    {
+        if (!valid(addr, size, _eraseSize))
+        {
+            return BD_ERROR_DEVICE_ERROR;
+        }
+
+        memset(&_data[addr], 0xFF, size);
+        return BD_ERROR_OK;
+    }
+
+    virtual bd_size_t get_read_size() const override { return _readSize; }
+
+    virtual bd_size_t get_program_size() const override { return _programSize; }
+
+    virtual bd_size_t get_erase_size() const override { return _eraseSize; }
+
+    virtual bd_size_t size() const override { return _size; }
+
+    virtual const char* get_type() const override { return "HEAP"; }
+
+private:
+    bool valid(bd_addr_t addr, bd_size_t size, bd_size_t unit) const
+    {
+        return !_data.empty() && addr % unit == 0 && size % unit == 0 && addr + size <= _size;
+    }
+
+    bd_size_t _size;
+    bd_size_t _readSize;
+    bd_size_t _programSize;
+    bd_size_t _eraseSize;
+    std::vector<uint8_t> _data;
+};
+} // namespace mbed
+
+using mbed::HeapBlockDevice;
+
+#endif
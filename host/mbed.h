@@ -0,0 +1,685 @@
+/**
+ * @file mbed.h
+ * @brief Minimal Mbed OS 6 shim for building the KX134 driver on a host
+ *
+ * Provides the subset of the Mbed OS API the driver, KX134Sim and the benchmark use, on top of the
+ * C++ standard library. There is no hardware behind it: SPI reads back zeros, I2C transfers are not
+ * acknowledged and InterruptIn never fires, so only KX134Sim finds a KX134. Interrupt lines are
+ * simulated by KX134Sim through KX134Base::handleInterrupt().
+ */
+
+#ifndef KX134_HOST_MBED_H
+#define KX134_HOST_MBED_H
+
+#include <cassert>
+#include <chrono>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <list>
+#include <mutex>
+#include <thread>
+
+#define MBED_ASSERT(expr) assert(expr)
+
+/** Asynchronous SPI is declared so its code builds, but transfers are rejected */
+#define DEVICE_SPI_ASYNCH 1
+
+#define SPI_EVENT_ERROR (1 << 1)
+#define SPI_EVENT_COMPLETE (1 << 2)
+#define SPI_EVENT_RX_OVERFLOW (1 << 3)
+#define SPI_EVENT_ALL (SPI_EVENT_ERROR | SPI_EVENT_COMPLETE | SPI_EVENT_RX_OVERFLOW)
+
+#define osFlagsError 0x80000000U
+#define osFlagsErrorTimeout 0xFFFFFFFEU
+
+#define EVENTS_EVENT_SIZE 64
+#define EVENTS_QUEUE_SIZE (32 * EVENTS_EVENT_SIZE)
+
+// clang-format off
+enum PinName
+{
+    PA_0, PA_1, PA_2, PA_3, PA_4, PA_5, PA_6, PA_7, PA_8, PA_9, PA_10, PA_11, PA_12, PA_13, PA_14, PA_15,
+    PB_0, PB_1, PB_2, PB_3, PB_4, PB_5, PB_6, PB_7, PB_8, PB_9, PB_10, PB_11, PB_12, PB_13, PB_14, PB_15,
+    PC_0, PC_1, PC_2, PC_3, PC_4, PC_5, PC_6, PC_7, PC_8, PC_9, PC_10, PC_11, PC_12, PC_13, PC_14, PC_15,
+    PD_0, PD_1, PD_2, PD_3, PD_4, PD_5, PD_6, PD_7, PD_8, PD_9, PD_10, PD_11, PD_12, PD_13, PD_14, PD_15,
+    PE_0, PE_1, PE_2, PE_3, PE_4, PE_5, PE_6, PE_7, PE_8, PE_9, PE_10, PE_11, PE_12, PE_13, PE_14, PE_15,
+    NC = -1
+};
+// clang-format on
+
+enum DMAUsage
+{
+    DMA_USAGE_NEVER,
+    DMA_USAGE_OPPORTUNISTIC,
+    DMA_USAGE_ALWAYS,
+    DMA_USAGE_TEMPORARY_ALLOCATED,
+    DMA_USAGE_ALLOCATED
+};
+
+inline void wait_us(int us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+
+inline void wait_ns(unsigned int ns) { std::this_thread::sleep_for(std::chrono::nanoseconds(ns)); }
+
+namespace mbed
+{
+template <typename Signature> class Callback;
+
+/**
+ * @brief Callback holding a function, functor or bound member function
+ */
+template <typename R, typename... ArgTs> class Callback<R(ArgTs...)>
+{
+public:
+    Callback() { }
+
+    Callback(std::nullptr_t) { }
+
+    template <typename F> Callback(F f)
+        : _function(f)
+    {
+    }
+
+    template <typename T, typename U> Callback(U* obj, R (T::*method)(ArgTs...))
+        : _function([obj, method](ArgTs... args) { return (obj->*method)(args...); })
+    {
+    }
+
+    template <typename T, typename U> Callback(const U* obj, R (T::*method)(ArgTs...) const)
+        : _function([obj, method](ArgTs... args) { return (obj->*method)(args...); })
+    {
+    }
+
+    R call(ArgTs... args) const { return _function(args...); }
+
+    R operator()(ArgTs... args) const { return _function(args...); }
+
+    explicit operator bool() const { return static_cast<bool>(_function); }
+
+private:
+    std::function<R(ArgTs...)> _function;
+};
+
+template <typename T, typename U, typename R, typename... ArgTs>
+Callback<R(ArgTs...)> callback(U* obj, R (T::*method)(ArgTs...))
+{
+    return Callback<R(ArgTs...)>(obj, method);
+}
+
+template <typename T, typename U, typename R, typename... ArgTs>
+Callback<R(ArgTs...)> callback(const U* obj, R (T::*method)(ArgTs...) const)
+{
+    return Callback<R(ArgTs...)>(obj, method);
+}
+
+template <typename R, typename... ArgTs> Callback<R(ArgTs...)> callback(R (*function)(ArgTs...))
+{
+    return Callback<R(ArgTs...)>(function);
+}
+
+typedef Callback<void(int)> event_callback_t;
+
+constexpr ptrdiff_t SPAN_DYNAMIC_EXTENT = -1;
+
+/**
+ * @brief Non-owning view of contiguous elements
+ */
+template <typename ElementType, ptrdiff_t Extent = SPAN_DYNAMIC_EXTENT> class Span
+{
+public:
+    typedef ElementType element_type;
+    typedef ptrdiff_t index_type;
+
+    Span()
+        : _data(nullptr)
+        , _size(0)
+    {
+    }
+
+    Span(ElementType* data, index_type size)
+        : _data(data)
+        , _size(size)
+    {
+    }
+
+    template <size_t N> Span(ElementType (&elements)[N])
+        : _data(elements)
+        , _size(N)
+    {
+    }
+
+    ElementType* data() const { return _data; }
+
+    index_type size() const { return _size; }
+
+    bool empty() const { return _size == 0; }
+
+    ElementType& operator[](index_type index) const { return _data[index]; }
+
+    ElementType* begin() const { return _data; }
+
+    ElementType* end() const { return _data + _size; }
+
+private:
+    ElementType* _data;
+    index_type _size;
+};
+
+/**
+ * @brief Monotonic microsecond clock, as the target's high-resolution ticker
+ */
+struct HighResClock
+{
+    typedef std::chrono::microseconds duration;
+    typedef duration::rep rep;
+    typedef duration::period period;
+    typedef std::chrono::time_point<HighResClock> time_point;
+    static constexpr bool is_steady = true;
+
+    static time_point now()
+    {
+        return time_point(std::chrono::duration_cast<duration>(
+            std::chrono::steady_clock::now().time_since_epoch()));
+    }
+};
+
+/**
+ * @brief Stopwatch on the host's steady clock. Accumulates at full resolution across start/stop.
+ */
+class Timer
+{
+public:
+    Timer()
+        : _running(false)
+        , _elapsed(0)
+    {
+    }
+
+    void start()
+    {
+        if (!_running)
+        {
+            _startTime = std::chrono::steady_clock::now();
+            _running = true;
+        }
+    }
+
+    void stop()
+    {
+        if (_running)
+        {
+            _elapsed += std::chrono::steady_clock::now() - _startTime;
+            _running = false;
+        }
+    }
+
+    void reset()
+    {
+        _elapsed = std::chrono::steady_clock::duration(0);
+        _startTime = std::chrono::steady_clock::now();
+    }
+
+    std::chrono::microseconds elapsed_time() const
+    {
+        std::chrono::steady_clock::duration elapsed = _elapsed;
+        if (_running)
+        {
+            elapsed += std::chrono::steady_clock::now() - _startTime;
+        }
+        return std::chrono::duration_cast<std::chrono::microseconds>(elapsed);
+    }
+
+private:
+    bool _running;
+    std::chrono::steady_clock::time_point _startTime;
+    std::chrono::steady_clock::duration _elapsed;
+};
+
+typedef Timer LowPowerTimer;
+
+/**
+ * @brief Digital output with no pin behind it
+ */
+class DigitalOut
+{
+public:
+    DigitalOut(PinName pin, int value = 0)
+        : _value(value)
+    {
+        (void)pin;
+    }
+
+    void write(int value) { _value = value; }
+
+    int read() { return _value; }
+
+    DigitalOut& operator=(int value)
+    {
+        write(value);
+        return *this;
+    }
+
+private:
+    int _value;
+};
+
+/**
+ * @brief Interrupt input with no pin behind it. The handlers are stored but never called.
+ */
+class InterruptIn
+{
+public:
+    InterruptIn(PinName pin) { (void)pin; }
+
+    void rise(Callback<void()> handler) { _rise = handler; }
+
+    void fall(Callback<void()> handler) { _fall = handler; }
+
+    void enable_irq() { }
+
+    void disable_irq() { }
+
+    int read() { return 0; }
+
+private:
+    Callback<void()> _rise;
+    Callback<void()> _fall;
+};
+
+/**
+ * @brief SPI master with no device on the bus: reads return zeros
+ */
+class SPI
+{
+public:
+    SPI(PinName mosi, PinName miso, PinName sclk, PinName ssel = NC)
+        : _defaultWriteValue(0)
+    {
+        (void)mosi;
+        (void)miso;
+        (void)sclk;
+        (void)ssel;
+    }
+
+    void format(int bits, int mode = 0)
+    {
+        (void)bits;
+        (void)mode;
+    }
+
+    void frequency(int hz = 1000000) { (void)hz; }
+
+    int write(int value)
+    {
+        (void)value;
+        return 0;
+    }
+
+    int write(const char* txBuffer, int txLength, char* rxBuffer, int rxLength)
+    {
+        (void)txBuffer;
+        if (rxBuffer != nullptr)
+        {
+            memset(rxBuffer, 0, rxLength);
+        }
+        return txLength > rxLength ? txLength : rxLength;
+    }
+
+    void set_default_write_value(char value) { _defaultWriteValue = value; }
+
+    void lock() { _mutex.lock(); }
+
+    void unlock() { _mutex.unlock(); }
+
+    int set_dma_usage(DMAUsage usage)
+    {
+        (void)usage;
+        return 0;
+    }
+
+    /**
+     * @brief Starts a non-blocking transfer. There is no peripheral to run it, so it is rejected.
+     *
+     * @return -1, as a busy peripheral
+     */
+    template <typename Type>
+    int transfer(const Type* txBuffer, int txLength, Type* rxBuffer, int rxLength,
+        const event_callback_t& callback, int event = SPI_EVENT_COMPLETE)
+    {
+        (void)txBuffer;
+        (void)txLength;
+        (void)rxBuffer;
+        (void)rxLength;
+        (void)callback;
+        (void)event;
+        return -1;
+    }
+
+    void abort_transfer() { }
+
+private:
+    char _defaultWriteValue;
+    std::recursive_mutex _mutex;
+};
+
+/**
+ * @brief I2C master with no device on the bus: transfers are not acknowledged
+ */
+class I2C
+{
+public:
+    I2C(PinName sda, PinName scl)
+    {
+        (void)sda;
+        (void)scl;
+    }
+
+    void frequency(int hz) { (void)hz; }
+
+    int read(int address, char* data, int length, bool repeated = false)
+    {
+        (void)address;
+        (void)data;
+        (void)length;
+        (void)repeated;
+        return -1;
+    }
+
+    int write(int address, const char* data, int length, bool repeated = false)
+    {
+        (void)address;
+        (void)data;
+        (void)length;
+        (void)repeated;
+        return -1;
+    }
+
+    void lock() { _mutex.lock(); }
+
+    void unlock() { _mutex.unlock(); }
+
+private:
+    std::recursive_mutex _mutex;
+};
+} // namespace mbed
+
+namespace rtos
+{
+namespace Kernel
+{
+    /**
+     * @brief RTOS millisecond clock
+     */
+    struct Clock
+    {
+        typedef std::chrono::milliseconds duration;
+        typedef std::chrono::duration<uint32_t, std::milli> duration_u32;
+        typedef duration::rep rep;
+        typedef duration::period period;
+        typedef std::chrono::time_point<Clock> time_point;
+        static constexpr bool is_steady = true;
+
+        static time_point now()
+        {
+            return time_point(std::chrono::duration_cast<duration>(
+                std::chrono::steady_clock::now().time_since_epoch()));
+        }
+    };
+
+    constexpr Clock::duration_u32 wait_for_u32_forever(UINT32_MAX);
+} // namespace Kernel
+
+namespace ThisThread
+{
+    inline void yield() { std::this_thread::yield(); }
+
+    template <typename Rep, typename Period> void sleep_for(std::chrono::duration<Rep, Period> rel)
+    {
+        std::this_thread::sleep_for(rel);
+    }
+} // namespace ThisThread
+
+typedef std::recursive_mutex Mutex;
+
+/**
+ * @brief Event flags that threads can wait on and interrupt handlers can set
+ */
+class EventFlags
+{
+public:
+    EventFlags()
+        : _flags(0)
+    {
+    }
+
+    uint32_t set(uint32_t flags)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _flags |= flags;
+        _changed.notify_all();
+        return _flags;
+    }
+
+    uint32_t clear(uint32_t flags = 0x7FFFFFFF)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        uint32_t previous = _flags;
+        _flags &= ~flags;
+        return previous;
+    }
+
+    uint32_t get() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _flags;
+    }
+
+    uint32_t wait_any_for(uint32_t flags, Kernel::Clock::duration_u32 rel_time, bool clear = true)
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+
+        auto fired = [&]() { return (_flags & flags) != 0; };
+        if (rel_time == Kernel::wait_for_u32_forever)
+        {
+            _changed.wait(lock, fired);
+        }
+        else if (!_changed.wait_for(lock, rel_time, fired))
+        {
+            return osFlagsErrorTimeout;
+        }
+
+        uint32_t result = _flags;
+        if (clear)
+        {
+            _flags &= ~flags;
+        }
+        return result;
+    }
+
+    uint32_t wait_any(uint32_t flags = 0, uint32_t millisec = UINT32_MAX, bool clear = true)
+    {
+        return wait_any_for(flags, Kernel::Clock::duration_u32(millisec), clear);
+    }
+
+private:
+    uint32_t _flags;
+    mutable std::mutex _mutex;
+    std::condition_variable _changed;
+};
+} // namespace rtos
+
+namespace events
+{
+/**
+ * @brief Queue of deferred calls, run by the thread dispatching it
+ *
+ * Like the target's queue, it has a fixed capacity: calls made while size / EVENTS_EVENT_SIZE events
+ * are pending fail and return 0.
+ */
+class EventQueue
+{
+public:
+    typedef std::chrono::duration<int, std::milli> duration;
+
+    EventQueue(unsigned size = EVENTS_QUEUE_SIZE, unsigned char* buffer = nullptr)
+        : _capacity(size / EVENTS_EVENT_SIZE)
+        , _nextId(1)
+        , _breakDispatch(false)
+    {
+        (void)buffer;
+    }
+
+    template <typename F, typename... ArgTs> int call(F f, ArgTs... args)
+    {
+        return post(duration(0), duration(-1), std::bind(f, args...));
+    }
+
+    template <typename T, typename U, typename R, typename... BoundTs, typename... ArgTs>
+    int call(U* obj, R (T::*method)(BoundTs...), ArgTs... args)
+    {
+        return post(duration(0), duration(-1), std::bind(method, obj, args...));
+    }
+
+    template <typename F, typename... ArgTs> int call_in(duration ms, F f, ArgTs... args)
+    {
+        return post(ms, duration(-1), std::bind(f, args...));
+    }
+
+    template <typename T, typename U, typename R, typename... BoundTs, typename... ArgTs>
+    int call_in(duration ms, U* obj, R (T::*method)(BoundTs...), ArgTs... args)
+    {
+        return post(ms, duration(-1), std::bind(method, obj, args...));
+    }
+
+    template <typename F, typename... ArgTs> int call_every(duration ms, F f, ArgTs... args)
+    {
+        return post(ms, ms, std::bind(f, args...));
+    }
+
+    template <typename T, typename U, typename R, typename... BoundTs, typename... ArgTs>
+    int call_every(duration ms, U* obj, R (T::*method)(BoundTs...), ArgTs... args)
+    {
+        return post(ms, ms, std::bind(method, obj, args...));
+    }
+
+    bool cancel(int id)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        for (auto event = _events.begin(); event != _events.end(); ++event)
+        {
+            if (event->id == id)
+            {
+                _events.erase(event);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Runs the events that are due, without waiting
+     */
+    void dispatch_once() { dispatch_for(duration(0)); }
+
+    /**
+     * @brief Runs events as they become due for a given time
+     *
+     * @param[in] ms The time to dispatch for
+     */
+    void dispatch_for(duration ms)
+    {
+        const auto end = std::chrono::steady_clock::now() + ms;
+        _breakDispatch = false;
+
+        do
+        {
+            while (runOne())
+            {
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        } while (!_breakDispatch && std::chrono::steady_clock::now() < end);
+    }
+
+    void break_dispatch() { _breakDispatch = true; }
+
+private:
+    struct Event
+    {
+        int id;
+        std::chrono::steady_clock::time_point due;
+        duration period;
+        std::function<void()> function;
+    };
+
+    int post(duration delay, duration period, std::function<void()> function)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_events.size() >= _capacity)
+        {
+            return 0;
+        }
+
+        int id = _nextId++;
+        _events.push_back({ id, std::chrono::steady_clock::now() + delay, period, function });
+        return id;
+    }
+
+    /**
+     * @brief Runs the earliest due event
+     *
+     * @return true if an event was run, false if none is due
+     */
+    bool runOne()
+    {
+        std::function<void()> function;
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            const auto now = std::chrono::steady_clock::now();
+
+            auto due = _events.end();
+            for (auto event = _events.begin(); event != _events.end(); ++event)
+            {
+                if (event->due <= now && (due == _events.end() || event->due < due->due))
+                {
+                    due = event;
+                }
+            }
+            if (due == _events.end())
+            {
+                return false;
+            }
+
+            function = due->function;
+            if (due->period.count() >= 0)
+            {
+                due->due += due->period;
+            }
+            else
+            {
+                _events.erase(due);
+            }
+        }
+
+        function();
+        return true;
+    }
+
+    size_t _capacity;
+    int _nextId;
+    volatile bool _breakDispatch;
+    std::mutex _mutex;
+    std::list<Event> _events;
+};
+} // namespace events
+
+using namespace mbed;
+using namespace rtos;
+using namespace events;
+using namespace std::chrono_literals;
+
+#endif
@@ -0,0 +1,61 @@
+/**
+ * @file mbed_trace.h
+ * @brief Host shim of the mbed-trace macros, printing to stdout when enabled
+ */
+
+#ifndef KX134_HOST_MBED_TRACE_H
+#define KX134_HOST_MBED_TRACE_H
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstdio>
+
+#ifndef MBED_CONF_MBED_TRACE_ENABLE
+#define MBED_CONF_MBED_TRACE_ENABLE 0
+#endif
+
+#if MBED_CONF_MBED_TRACE_ENABLE
+
+inline void mbed_trace_init() { }
+
+inline void mbed_tracef(const char* level, const char* group, const char* format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    printf("[%s][%-4s]: ", level, group);
+    vprintf(format, args);
+    printf("\r\n");
+    va_end(args);
+}
+
+inline char* mbed_trace_array(const uint8_t* buffer, uint16_t length)
+{
+    static char text[3 * 64 + 1];
+    size_t used = 0;
+    text[0] = '\0';
+
+    for (uint16_t i = 0; i < length && used + 4 <= sizeof(text); ++i)
+    {
+        used += snprintf(text + used, sizeof(text) - used, i == 0 ? "%02x" : ":%02x", buffer[i]);
+    }
+    return text;
+}
+
+#define tr_error(...) mbed_tracef("ERR ", TRACE_GROUP, __VA_ARGS__)
+#define tr_warn(...) mbed_tracef("WARN", TRACE_GROUP, __VA_ARGS__)
+#define tr_info(...) mbed_tracef("INFO", TRACE_GROUP, __VA_ARGS__)
+#define tr_debug(...) mbed_tracef("DBG ", TRACE_GROUP, __VA_ARGS__)
+#define tr_array(buffer, length) mbed_trace_array(buffer, length)
+
+#else
+
+#define mbed_trace_init(...) ((void)0)
+#define tr_error(...) ((void)0)
+#define tr_warn(...) ((void)0)
+#define tr_info(...) ((void)0)
+#define tr_debug(...) ((void)0)
+#define tr_array(...) ((char*)0)
+
+#endif
+
+#endif
@@ -0,0 +1,50 @@
+#ifndef KX134TEST_H
+#define KX134TEST_H
+
+#include <cstdio>
+
+/**
+ * @brief Minimal checks for the host tests: a failed check is reported and fails the test
+ */
+static int kx134TestFailures = 0;
+
+#define CHECK(condition)                                                                           \
+    do                                                                                             \
+    {                                                                                              \
+        if (!(condition))                                                                          \
+        {                                                                                          \
+            printf("%s:%d: CHECK(%s) failed\r\n", __FILE__, __LINE__, #condition);                 \
+            ++kx134TestFailures;                                                                   \
+        }                                                                                          \
+    } while (0)
+
+#define CHECK_EQUAL(expected, actual)                                                              \
+    do                                                                                             \
+    {                                                                                              \
+        long long expectedValue = static_cast<long long>(expected);                                \
+        long long actualValue = static_cast<long long>(actual);                                    \
+        if (expectedValue != actualValue)                                                          \
+        {                                                                                          \
+            printf("%s:%d: expected %s == %lld, got %lld\r\n",                                     \
+                __FILE__,                                                                          \
+                __LINE__,                                                                          \
+                #actual,                                                                           \
+                expectedValue,                                                                     \
+                actualValue);                                                                      \
+            ++kx134TestFailures;                                                                   \
+        }                                                                                          \
+    } while (0)
+
+/**
+ * @brief Reports the result of a test program
+ *
+ * @return The exit status: 0 if all checks passed, 1 otherwise
+ */
+static inline int kx134TestResult()
+{
+    printf(kx134TestFailures == 0 ? "[SUCCESS]\r\n" : "[FAILURE] %d checks failed\r\n",
+        kx134TestFailures);
+    return kx134TestFailures == 0 ? 0 : 1;
+}
+
+#endif
@@ -0,0 +1,96 @@
+//
+// Initialization completed on an EventQueue, including when the queue is full
+//
+
+#include "KX134Sim.h"
+#include "KX134Test.h"
+
+static int readyCount = 0;
+static bool lastReady = false;
+
+static void onReady(bool ready)
+{
+    ++readyCount;
+    lastReady = ready;
+}
+
+/**
+ * @brief KX134Sim that fills an EventQueue when the reset is polled
+ */
+class FillingSim : public KX134Sim
+{
+public:
+    FillingSim(EventQueue& queue)
+        : _queue(queue)
+        , _fill(false)
+    {
+    }
+
+    void fillOnPoll() { _fill = true; }
+
+protected:
+    virtual uint32_t timeUs() override
+    {
+        if (_fill)
+        {
+            _queue.call_in(std::chrono::hours(1), [] {});
+        }
+        return KX134Sim::timeUs();
+    }
+
+private:
+    EventQueue& _queue;
+    bool _fill;
+};
+
+static void testReady()
+{
+    EventQueue queue;
+    KX134Sim sim;
+    readyCount = 0;
+
+    CHECK(sim.startInit(queue, callback(onReady)));
+    sim.advance(KX134Base::RESET_TIME);
+    queue.dispatch_for(std::chrono::milliseconds(20));
+
+    CHECK_EQUAL(1, readyCount);
+    CHECK(lastReady);
+    CHECK(sim.getInitState() == KX134Base::InitState::READY);
+}
+
+static void testQueueFullAtStart()
+{
+    EventQueue queue(0);
+    KX134Sim sim;
+    readyCount = 0;
+
+    CHECK(!sim.startInit(queue, callback(onReady)));
+    CHECK_EQUAL(1, readyCount);
+    CHECK(!lastReady);
+    CHECK(sim.getInitState() == KX134Base::InitState::FAILED);
+}
+
+static void testQueueFullWhilePolling()
+{
+    EventQueue queue(1 * EVENTS_EVENT_SIZE);
+    FillingSim sim(queue);
+    readyCount = 0;
+
+    CHECK(sim.startInit(queue, callback(onReady)));
+
+    // the simulated clock does not advance, so the reset is still running when first polled
+    sim.fillOnPoll();
+    queue.dispatch_for(std::chrono::milliseconds(20));
+
+    CHECK_EQUAL(1, readyCount);
+    CHECK(!lastReady);
+    CHECK(sim.getInitState() == KX134Base::InitState::FAILED);
+}
+
+int main()
+{
+    testReady();
+    testQueueFullAtStart();
+    testQueueFullWhilePolling();
+    return kx134TestResult();
+}
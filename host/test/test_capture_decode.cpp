@@ -0,0 +1,149 @@
+//
+// Encodes a capture through KX134CaptureWriter and decodes it back with KX134CaptureFormat
+//
+
+#include "HeapBlockDevice.h"
+#include "KX134CaptureFormat.h"
+#include "KX134CaptureWriter.h"
+#include "KX134Test.h"
+
+#define NUM_BLOCKS 32
+#define NUM_SAMPLES 1500
+#define PERIOD_US 40.0f
+
+/**
+ * @brief Generates a sample stream with small and large steps and one timestamp gap
+ */
+static void makeFrames(KX134Frame* frames, size_t count)
+{
+    uint32_t noise = 12345;
+    for (size_t i = 0; i < count; ++i)
+    {
+        noise = noise * 1103515245 + 12345;
+
+        // a missed sample splits the block, the decoder spaces samples evenly
+        uint32_t index = i < count / 2 ? i : i + 1;
+        frames[i].timestamp = 1000 + static_cast<uint32_t>(index * PERIOD_US);
+        frames[i].x = static_cast<int16_t>((noise >> 16) % 7) - 3;
+        frames[i].y = i % 100 == 0 ? INT16_MIN : static_cast<int16_t>(i * 37);
+        frames[i].z = 2048 + static_cast<int16_t>((noise >> 8) % 300);
+    }
+}
+
+/**
+ * @brief Decodes the data blocks of a capture
+ *
+ * @return The number of samples decoded
+ */
+static size_t decodeCapture(BlockDevice& device, bd_addr_t start, KX134Frame* output)
+{
+    uint8_t block[KX134CaptureWriter::BLOCK_SIZE];
+    size_t decoded = 0;
+
+    for (uint32_t sequence = 0; start + (sequence + 2) * sizeof(block) <= device.size(); ++sequence)
+    {
+        device.read(block, start + (sequence + 1) * sizeof(block), sizeof(block));
+
+        int count = KX134CaptureFormat::decodeBlock(
+            block, sizeof(block), sequence, output + decoded, NUM_SAMPLES - decoded);
+        if (count < 0)
+        {
+            break;
+        }
+        decoded += count;
+    }
+
+    return decoded;
+}
+
+static void testRoundTrip()
+{
+    static KX134Frame frames[NUM_SAMPLES];
+    static KX134Frame decoded[NUM_SAMPLES];
+    makeFrames(frames, NUM_SAMPLES);
+
+    HeapBlockDevice device(NUM_BLOCKS * KX134CaptureWriter::BLOCK_SIZE,
+        1,
+        1,
+        KX134CaptureWriter::BLOCK_SIZE);
+    device.init();
+
+    KX134CaptureFormat::Header header = {};
+    header.rangeG = 32;
+    header.outputDataRate = 0b1100;
+    header.offsets[2] = -12;
+    header.gravsPerLsb = 0.000976f;
+
+    KX134CaptureWriter writer(device);
+    CHECK_EQUAL(BD_ERROR_OK, writer.begin(header));
+    CHECK_EQUAL(BD_ERROR_OK, writer.write(frames, NUM_SAMPLES, PERIOD_US));
+    CHECK_EQUAL(BD_ERROR_OK, writer.flush());
+    CHECK_EQUAL(NUM_SAMPLES, writer.samplesWritten());
+
+    uint8_t block[KX134CaptureWriter::BLOCK_SIZE];
+    device.read(block, 0, sizeof(block));
+    KX134CaptureFormat::Header decodedHeader;
+    CHECK(KX134CaptureFormat::decodeHeader(block, sizeof(block), decodedHeader));
+    CHECK_EQUAL(32, decodedHeader.rangeG);
+    CHECK_EQUAL(0b1100, decodedHeader.outputDataRate);
+    CHECK_EQUAL(KX134CaptureWriter::BLOCK_SIZE, decodedHeader.blockSize);
+    CHECK_EQUAL(-12, decodedHeader.offsets[2]);
+    CHECK(decodedHeader.gravsPerLsb == header.gravsPerLsb);
+
+    CHECK_EQUAL(NUM_SAMPLES, decodeCapture(device, 0, decoded));
+    for (size_t i = 0; i < NUM_SAMPLES; ++i)
+    {
+        CHECK_EQUAL(frames[i].x, decoded[i].x);
+        CHECK_EQUAL(frames[i].y, decoded[i].y);
+        CHECK_EQUAL(frames[i].z, decoded[i].z);
+
+        int32_t error = static_cast<int32_t>(decoded[i].timestamp - frames[i].timestamp);
+        CHECK(error >= -1 && error <= 1);
+    }
+
+    // a corrupted block ends the capture
+    device.read(block, 3 * sizeof(block), sizeof(block));
+    block[40] ^= 0x01;
+    device.program(block, 3 * sizeof(block), sizeof(block));
+    CHECK(decodeCapture(device, 0, decoded) < NUM_SAMPLES);
+
+    device.deinit();
+}
+
+static void testRestart()
+{
+    static KX134Frame frames[NUM_SAMPLES];
+    static KX134Frame decoded[NUM_SAMPLES];
+    makeFrames(frames, NUM_SAMPLES);
+
+    // erase sectors span several blocks, so a capture does not end on a sector boundary
+    HeapBlockDevice device(NUM_BLOCKS * KX134CaptureWriter::BLOCK_SIZE, 1, 1, 4096);
+    device.init();
+
+    KX134CaptureFormat::Header header = {};
+    header.rangeG = 8;
+
+    KX134CaptureWriter writer(device, 4096);
+    CHECK_EQUAL(BD_ERROR_OK, writer.begin(header));
+    CHECK_EQUAL(BD_ERROR_OK, writer.write(frames, 100, PERIOD_US));
+    CHECK_EQUAL(BD_ERROR_OK, writer.flush());
+
+    // a new capture starts over at the start address
+    CHECK_EQUAL(BD_ERROR_OK, writer.begin(header));
+    CHECK_EQUAL(BD_ERROR_OK, writer.write(frames, NUM_SAMPLES / 2, PERIOD_US));
+    CHECK_EQUAL(BD_ERROR_OK, writer.flush());
+    CHECK_EQUAL(NUM_SAMPLES / 2, decodeCapture(device, 4096, decoded));
+
+    // the start address must be on an erase sector boundary
+    KX134CaptureWriter unaligned(device, KX134CaptureWriter::BLOCK_SIZE);
+    CHECK_EQUAL(BD_ERROR_DEVICE_ERROR, unaligned.begin(header));
+
+    device.deinit();
+}
+
+int main()
+{
+    testRoundTrip();
+    testRestart();
+    return kx134TestResult();
+}
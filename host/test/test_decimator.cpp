@@ -0,0 +1,152 @@
+//
+// FIR and CIC decimators: DC gain, output counts, Q15 saturation and CIC register growth
+//
+
+#include <cmath>
+
+#include "KX134Decimator.h"
+#include "KX134Test.h"
+
+#define BLOCK_SAMPLES 256
+
+/**
+ * @brief Fills a block with a constant value on every axis
+ */
+static void fill(int16_t* block, size_t samples, int16_t value)
+{
+    for (size_t i = 0; i < 3 * samples; ++i)
+    {
+        block[i] = value;
+    }
+}
+
+static void testFirDcGain()
+{
+    static int16_t input[BLOCK_SAMPLES * 3];
+    fill(input, BLOCK_SAMPLES, 1000);
+
+    float coefficientsF32[32];
+    KX134FirDecimatorF32::designLowPass(coefficientsF32, 32, 4);
+    KX134FirDecimatorF32 f32(coefficientsF32, 32, 4);
+
+    static float outputF32[(BLOCK_SAMPLES / 4 + 1) * 3];
+    size_t count = f32.process(input, BLOCK_SAMPLES, outputF32);
+    CHECK_EQUAL(BLOCK_SAMPLES / 4, count);
+
+    // once the history is full of the constant, the output is that constant
+    for (size_t i = 3 * (32 / 4); i < 3 * count; ++i)
+    {
+        CHECK(std::fabs(outputF32[i] - 1000.0f) < 0.1f);
+    }
+
+    int16_t coefficientsQ15[32];
+    KX134FirDecimatorQ15::designLowPass(coefficientsQ15, 32, 4);
+    KX134FirDecimatorQ15 q15(coefficientsQ15, 32, 4);
+
+    static int16_t outputQ15[(BLOCK_SAMPLES / 4 + 1) * 3];
+    count = q15.process(input, BLOCK_SAMPLES, outputQ15);
+    CHECK_EQUAL(BLOCK_SAMPLES / 4, count);
+
+    // the coefficients are rounded to Q15, so the gain is within 32 * 2^-16 of 1
+    for (size_t i = 3 * (32 / 4); i < 3 * count; ++i)
+    {
+        CHECK(std::abs(outputQ15[i] - 1000) <= 1);
+    }
+}
+
+static void testOutputCount()
+{
+    static int16_t input[BLOCK_SAMPLES * 3];
+    static float output[BLOCK_SAMPLES * 3];
+    fill(input, BLOCK_SAMPLES, 0);
+
+    float coefficients[9];
+    KX134FirDecimatorF32::designLowPass(coefficients, 9, 3);
+    KX134FirDecimatorF32 fir(coefficients, 9, 3);
+
+    // the phase carries across blocks: 10 + 2 + 9 samples give 3 + 1 + 3 outputs
+    CHECK_EQUAL(3, fir.process(input, 10, output));
+    CHECK_EQUAL(1, fir.process(input, 2, output));
+    CHECK_EQUAL(3, fir.process(input, 9, output));
+
+    // and restarts on reset()
+    fir.reset();
+    CHECK_EQUAL(0, fir.process(input, 2, output));
+
+    static int16_t cicOutput[BLOCK_SAMPLES * 3];
+    KX134CicDecimator cic(8, 3);
+    CHECK_EQUAL(0, cic.process(input, 7, cicOutput));
+    CHECK_EQUAL(1, cic.process(input, 1, cicOutput));
+    CHECK_EQUAL(BLOCK_SAMPLES / 8, cic.process(input, BLOCK_SAMPLES, cicOutput));
+}
+
+static void testQ15Saturation()
+{
+    // a gain of about 2 takes large inputs out of the int16_t range
+    const int16_t coefficients[2] = { INT16_MAX, INT16_MAX };
+    KX134FirDecimatorQ15 fir(coefficients, 2, 1);
+
+    int16_t input[3 * 2] = { 30000, -30000, 100, 30000, -30000, 100 };
+    int16_t output[3 * 2];
+    CHECK_EQUAL(2, fir.process(input, 2, output));
+
+    CHECK_EQUAL(INT16_MAX, output[3]);
+    CHECK_EQUAL(INT16_MIN, output[4]);
+    CHECK_EQUAL(200, output[5]);
+}
+
+static void testCicDcGain()
+{
+    static int16_t input[BLOCK_SAMPLES * 3];
+    static int16_t output[BLOCK_SAMPLES * 3];
+
+    // at MAX_GAIN, full-scale inputs use all 32 bits of the integrators
+    const int16_t levels[] = { 1000, -1000, INT16_MAX, INT16_MIN };
+    for (int16_t level : levels)
+    {
+        for (bool compensate : { false, true })
+        {
+            KX134CicDecimator cic(16, 4, compensate);
+            fill(input, BLOCK_SAMPLES, level);
+
+            size_t count = cic.process(input, BLOCK_SAMPLES, output);
+            CHECK_EQUAL(BLOCK_SAMPLES / 16, count);
+            CHECK_EQUAL(level, output[3 * (count - 1)]);
+            CHECK_EQUAL(level, output[3 * (count - 1) + 2]);
+        }
+    }
+}
+
+static void testCicSupported()
+{
+    CHECK(KX134CicDecimator::isSupported(16, 4));
+    CHECK(!KX134CicDecimator::isSupported(17, 4));
+    CHECK(KX134CicDecimator::isSupported(40, 3));
+    CHECK(!KX134CicDecimator::isSupported(41, 3));
+    CHECK(KX134CicDecimator::isSupported(KX134CicDecimator::MAX_GAIN, 1));
+    CHECK(!KX134CicDecimator::isSupported(KX134CicDecimator::MAX_GAIN + 1, 1));
+    CHECK(!KX134CicDecimator::isSupported(0, 1));
+    CHECK(!KX134CicDecimator::isSupported(2, KX134CicDecimator::MAX_STAGES + 1));
+
+#ifdef NDEBUG
+    // without assertions, stages are dropped until the gain fits
+    KX134CicDecimator cic(64, 4);
+    CHECK_EQUAL(2, cic.getStages());
+
+    static int16_t input[BLOCK_SAMPLES * 3];
+    static int16_t output[BLOCK_SAMPLES * 3];
+    fill(input, BLOCK_SAMPLES, INT16_MIN);
+    size_t count = cic.process(input, BLOCK_SAMPLES, output);
+    CHECK_EQUAL(INT16_MIN, output[3 * (count - 1)]);
+#endif
+}
+
+int main()
+{
+    testFirDcGain();
+    testOutputCount();
+    testQ15Saturation();
+    testCicDcGain();
+    testCicSupported();
+    return kx134TestResult();
+}
@@ -0,0 +1,54 @@
+//
+// I2C bus errors: the host I2C shim fails every transfer, as with no KX134 on the bus
+//
+
+#include "KX134I2C.h"
+#include "KX134Test.h"
+
+/**
+ * @brief KX134I2C exposing register reads
+ */
+class ReadableI2C : public KX134I2C
+{
+public:
+    ReadableI2C()
+        : KX134I2C(PB_9, PB_8, 0x1F)
+    {
+    }
+
+    using KX134I2C::readRegister;
+    using KX134Base::Register;
+};
+
+static void testFailedReadIsZeroed()
+{
+    ReadableI2C accel;
+
+    char buf[6];
+    memset(buf, 0xA5, sizeof(buf));
+    accel.readRegister(ReadableI2C::Register::XOUT_L, buf, sizeof(buf));
+
+    for (size_t i = 0; i < sizeof(buf); ++i)
+    {
+        CHECK_EQUAL(0, buf[i]);
+    }
+}
+
+static void testMissingDevice()
+{
+    ReadableI2C accel;
+    CHECK(!accel.checkExistence());
+
+    int16_t output[3] = { 1, 2, 3 };
+    accel.getAccelerations(output);
+    CHECK_EQUAL(0, output[0]);
+    CHECK_EQUAL(0, output[1]);
+    CHECK_EQUAL(0, output[2]);
+}
+
+int main()
+{
+    testFailedReadIsZeroed();
+    testMissingDevice();
+    return kx134TestResult();
+}
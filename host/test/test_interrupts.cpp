@@ -0,0 +1,76 @@
+//
+// Interrupt-driven delivery over KX134Sim's simulated interrupt lines
+//
+
+#include <atomic>
+#include <thread>
+
+#include "KX134Sim.h"
+#include "KX134Test.h"
+
+static std::atomic<int> callbackCount(0);
+static std::atomic<int> lastPin(-1);
+
+static void onInterrupt(KX134Base::InterruptPin pin)
+{
+    ++callbackCount;
+    lastPin = static_cast<int>(pin);
+}
+
+static void testDataReady()
+{
+    KX134Sim sim;
+    CHECK(sim.init());
+
+    sim.applyConfig(KX134Base::Config().outputDataRate(KX134Base::OutputDataRate::ODR_1600HZ));
+    sim.attachInterruptCallback(callback(onInterrupt));
+    sim.enableInterrupt(KX134Base::InterruptPin::INT1, NC, KX134Base::INT_DATA_READY);
+    sim.clearInterrupts();
+    sim.waitForInterrupt(KX134Base::INT1_FLAG, Kernel::Clock::duration_u32(0));
+    callbackCount = 0;
+
+    // nothing fires while no sample is taken
+    CHECK_EQUAL(0, sim.waitForInterrupt(KX134Base::INT1_FLAG, Kernel::Clock::duration_u32(10)));
+
+    // the waiting thread sleeps until another thread lets a sample be taken
+    std::thread producer([&sim]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        sim.advance(std::chrono::microseconds(1000));
+    });
+    uint32_t fired = sim.waitForInterrupt(KX134Base::INT1_FLAG | KX134Base::INT2_FLAG);
+    producer.join();
+
+    CHECK_EQUAL(KX134Base::INT1_FLAG, fired);
+    CHECK(callbackCount > 0);
+    CHECK_EQUAL(static_cast<int>(KX134Base::InterruptPin::INT1), lastPin);
+    CHECK(sim.dataReady());
+
+    sim.attachInterruptCallback(nullptr);
+}
+
+static void testWatermark()
+{
+    KX134Sim sim;
+    CHECK(sim.init());
+
+    sim.applyConfig(KX134Base::Config()
+                        .outputDataRate(KX134Base::OutputDataRate::ODR_1600HZ)
+                        .buffer(KX134Base::BufferMode::STREAM, 20));
+    sim.enableInterrupt(KX134Base::InterruptPin::INT2, NC, KX134Base::INT_WATERMARK);
+
+    // 10 samples stay below the watermark
+    sim.advance(std::chrono::microseconds(10 * 625));
+    CHECK_EQUAL(0, sim.waitForInterrupt(KX134Base::INT2_FLAG, Kernel::Clock::duration_u32(0)));
+
+    sim.advance(std::chrono::microseconds(12 * 625));
+    CHECK_EQUAL(KX134Base::INT2_FLAG,
+        sim.waitForInterrupt(KX134Base::INT2_FLAG, Kernel::Clock::duration_u32(0)));
+    CHECK(sim.getBufferSampleCount() >= 20);
+}
+
+int main()
+{
+    testDataReady();
+    testWatermark();
+    return kx134TestResult();
+}
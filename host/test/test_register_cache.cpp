@@ -0,0 +1,83 @@
+//
+// Register shadow cache: no-op writes are skipped and dirty registers are flushed in bursts
+//
+
+#include "KX134Sim.h"
+#include "KX134Test.h"
+
+/**
+ * @brief KX134Sim exposing the register cache
+ */
+class CacheSim : public KX134Sim
+{
+public:
+    using KX134Base::flushRegisters;
+    using KX134Base::getShadowRegister;
+    using KX134Base::Register;
+    using KX134Base::setShadowBits;
+};
+
+/**
+ * @brief Flushes after changing CNTL2 and another register, returning the transactions it took
+ */
+static uint32_t flushPair(CacheSim& sim, CacheSim::Register second, uint32_t* bytes)
+{
+    sim.setShadowBits(CacheSim::Register::CNTL2,
+        0x01,
+        ~sim.getShadowRegister(CacheSim::Register::CNTL2));
+    sim.setShadowBits(second, 0x01, ~sim.getShadowRegister(second));
+
+    KX134Base::BusStats before = sim.getBusStats();
+    sim.flushRegisters();
+    KX134Base::BusStats after = sim.getBusStats();
+
+    *bytes = after.bytes - before.bytes;
+    return after.transactions - before.transactions;
+}
+
+static void testSkippedWrites()
+{
+    CacheSim sim;
+    CHECK(sim.init());
+    sim.setAccelRange(KX134Base::Range::RANGE_8G); // operating
+
+    KX134Base::RegisterCacheStats before = sim.getRegisterCacheStats();
+    sim.setAccelRange(sim.getAccelRange());
+    KX134Base::RegisterCacheStats after = sim.getRegisterCacheStats();
+
+    CHECK_EQUAL(before.writes, after.writes);
+    CHECK(after.skippedWrites > before.skippedWrites);
+}
+
+static void testBurstGaps()
+{
+    CacheSim sim;
+    CHECK(sim.init());
+    sim.setAccelRange(KX134Base::Range::RANGE_8G); // operating
+
+    uint32_t bytes;
+
+    // each transaction costs one address byte. Stand-by and operate write CNTL1 (2 bytes each).
+
+    // CNTL2 and CNTL3 in one burst
+    CHECK_EQUAL(3, flushPair(sim, CacheSim::Register::CNTL3, &bytes));
+    CHECK_EQUAL(2 + 3 + 2, bytes);
+
+    // a gap of FLUSH_MAX_GAP (3) clean registers, CNTL3 to CNTL5, is rewritten: CNTL2..CNTL6
+    CHECK_EQUAL(3, flushPair(sim, CacheSim::Register::CNTL6, &bytes));
+    CHECK_EQUAL(2 + 6 + 2, bytes);
+
+    // a gap of 4, CNTL3 to CNTL6, costs a second transaction instead
+    CHECK_EQUAL(4, flushPair(sim, CacheSim::Register::ODCNTL, &bytes));
+    CHECK_EQUAL(2 + 2 + 2 + 2, bytes);
+
+    // the settings reached the KX134, and no write was ignored for being made while operating
+    CHECK_EQUAL(0, sim.ignoredWrites());
+}
+
+int main()
+{
+    testSkippedWrites();
+    testBurstGaps();
+    return kx134TestResult();
+}
@@ -0,0 +1,165 @@
+//
+// Timestamps of buffered reads against the times KX134Sim took the samples at, and the sample
+// clock's drift estimate under anchor jitter
+//
+
+#include <cmath>
+#include <cstdlib>
+
+#include "KX134Frame.h"
+#include "KX134SampleClock.h"
+#include "KX134Sim.h"
+#include "KX134Test.h"
+
+#define PERIOD_US 625 // 1600Hz
+
+/**
+ * @brief Signal encoding the time each sample was taken, in microseconds, into X and Y
+ */
+static void timeSignal(uint64_t timeNs, uint8_t rangeG, int16_t* output)
+{
+    (void)rangeG;
+
+    const uint32_t timeUs = timeNs / 1000;
+    output[0] = timeUs % 10000;
+    output[1] = timeUs / 10000;
+    output[2] = 0;
+}
+
+/**
+ * @brief Returns the largest timestamp error of frames, in microseconds
+ */
+static int32_t maxError(const KX134Frame* frames, size_t count)
+{
+    int32_t worst = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        uint32_t takenUs = frames[i].y * 10000 + frames[i].x;
+        int32_t error = std::abs(static_cast<int32_t>(frames[i].timestamp - takenUs));
+        worst = error > worst ? error : worst;
+    }
+    return worst;
+}
+
+static void setUp(KX134Sim& sim, uint8_t watermark)
+{
+    CHECK(sim.init());
+
+    // reads anchor the time their level read ends, so keep it much shorter than a sample period
+    sim.setBusTiming(10, 100);
+    sim.setSignalSource(callback(timeSignal));
+    sim.applyConfig(KX134Base::Config()
+                        .outputDataRate(KX134Base::OutputDataRate::ODR_1600HZ)
+                        .buffer(KX134Base::BufferMode::STREAM, watermark));
+    sim.clearBuffer();
+}
+
+static void testPartialReadsWithoutInterrupt()
+{
+    KX134Sim sim;
+    setUp(sim, 80);
+
+    KX134Frame frames[KX134Base::BUFFER_MAX_SAMPLES];
+
+    // drained reads anchor the newest sample at the time of the read
+    for (int i = 0; i < 4; ++i)
+    {
+        sim.advance(std::chrono::microseconds(20 * PERIOD_US));
+        size_t count = sim.readFrames(frames, KX134Base::BUFFER_MAX_SAMPLES);
+        CHECK(maxError(frames, count) <= PERIOD_US);
+    }
+
+    // partial reads leave 40 samples behind: their newest sample is not the newest taken
+    sim.advance(std::chrono::microseconds(40 * PERIOD_US));
+    for (int i = 0; i < 10; ++i)
+    {
+        sim.advance(std::chrono::microseconds(10 * PERIOD_US));
+        size_t count = sim.readFrames(frames, 10);
+        CHECK_EQUAL(10, count);
+        CHECK(maxError(frames, count) <= PERIOD_US);
+    }
+}
+
+static void testPartialReadsWithInterrupt()
+{
+    KX134Sim sim;
+    setUp(sim, 20);
+    sim.enableInterrupt(KX134Base::InterruptPin::INT1, NC, KX134Base::INT_WATERMARK);
+
+    KX134Frame frames[KX134Base::BUFFER_MAX_SAMPLES];
+
+    // reads of 15 samples per watermark of 20 leave 5 behind, then fewer as they catch up
+    for (int i = 0; i < 20; ++i)
+    {
+        sim.advance(std::chrono::microseconds((i % 2 == 0 ? 20 : 15) * PERIOD_US));
+        size_t count = sim.readFrames(frames, i % 3 == 0 ? KX134Base::BUFFER_MAX_SAMPLES : 15);
+        CHECK(maxError(frames, count) <= PERIOD_US);
+    }
+}
+
+static void testSlowBus()
+{
+    KX134Sim sim;
+    setUp(sim, 80);
+
+    // 400kHz I2C: a drain of 20 samples takes longer than 4 sample periods
+    const int32_t nsPerByte = 22500;
+    sim.setBusTiming(nsPerByte, 0);
+
+    KX134Frame frames[KX134Base::BUFFER_MAX_SAMPLES];
+
+    // the level read (3 bytes) bounds the error, not the burst read
+    for (int i = 0; i < 10; ++i)
+    {
+        sim.advance(std::chrono::microseconds(20 * PERIOD_US));
+        size_t count = sim.readFrames(frames, KX134Base::BUFFER_MAX_SAMPLES);
+        CHECK(count >= 20);
+        CHECK(maxError(frames, count) <= PERIOD_US + 3 * nsPerByte / 1000);
+    }
+}
+
+static void testJitterAfterRenewal()
+{
+    KX134SampleClock clock;
+    clock.reset(1000000.0f / PERIOD_US);
+
+    // exact anchors every 20 samples, renewing the reference at 4100
+    uint32_t index = 0;
+    for (; index <= 4100; index += 20)
+    {
+        clock.anchor(index * PERIOD_US, index);
+    }
+    CHECK(std::fabs(clock.getDriftPpm()) < 1.0f);
+
+    // 300us of interrupt latency 20 samples after the renewal does not move the period
+    clock.anchor(index * PERIOD_US + 300, index);
+    CHECK(std::fabs(clock.getDriftPpm()) < 1.0f);
+}
+
+static void testDriftWithJitter()
+{
+    KX134SampleClock clock;
+    clock.reset(1000000.0f / PERIOD_US);
+
+    // the KX134 runs 100ppm fast, and each anchor lands up to 200us late
+    const double periodUs = PERIOD_US / (1.0 + 100e-6);
+    uint32_t seed = 1;
+    for (uint32_t index = 0; index < 100000; index += 20)
+    {
+        seed = seed * 1664525 + 1013904223;
+        uint32_t latencyUs = (seed >> 16) % 200;
+        clock.anchor(static_cast<uint32_t>(index * periodUs) + latencyUs, index);
+    }
+
+    CHECK(std::fabs(clock.getDriftPpm() - 100.0f) < 25.0f);
+}
+
+int main()
+{
+    testPartialReadsWithoutInterrupt();
+    testPartialReadsWithInterrupt();
+    testSlowBus();
+    testJitterAfterRenewal();
+    testDriftWithJitter();
+    return kx134TestResult();
+}
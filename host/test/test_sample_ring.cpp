@@ -0,0 +1,156 @@
+//
+// Lock-free SPSC sample ring: full and empty rings, wrap-around and short reads
+//
+
+#include <thread>
+
+#include "KX134SampleRing.h"
+#include "KX134Test.h"
+
+static KX134Frame frame(uint32_t i)
+{
+    return { i, static_cast<int16_t>(i), static_cast<int16_t>(-i), static_cast<int16_t>(i * 2) };
+}
+
+static void testEmpty()
+{
+    KX134StaticSampleRing<8> ring;
+    KX134Frame out;
+
+    CHECK_EQUAL(8, ring.capacity());
+    CHECK_EQUAL(0, ring.size());
+    CHECK(!ring.pop(out));
+
+    KX134Frame block[4];
+    CHECK_EQUAL(0, ring.pop(Span<KX134Frame>(block, 4)));
+}
+
+static void testFull()
+{
+    KX134StaticSampleRing<8> ring;
+    KX134Frame frames[10];
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        frames[i] = frame(i);
+    }
+
+    // the last two frames do not fit and are dropped
+    CHECK_EQUAL(8, ring.push(frames, 10));
+    CHECK_EQUAL(8, ring.size());
+    CHECK_EQUAL(2, ring.dropCount());
+    CHECK(!ring.push(frame(10)));
+    CHECK_EQUAL(3, ring.dropCount());
+
+    // the stored frames are the oldest ones
+    KX134Frame out;
+    CHECK(ring.pop(out));
+    CHECK_EQUAL(0, out.timestamp);
+    CHECK(ring.push(frame(11)));
+    CHECK_EQUAL(8, ring.size());
+}
+
+static void testWrapAround()
+{
+    KX134StaticSampleRing<8> ring;
+    uint32_t pushed = 0;
+    uint32_t popped = 0;
+
+    // 5 in, 5 out leaves the indices straddling the end of the storage every other round
+    for (int round = 0; round < 10; ++round)
+    {
+        for (int i = 0; i < 5; ++i)
+        {
+            CHECK(ring.push(frame(pushed++)));
+        }
+
+        KX134Frame block[5];
+        CHECK_EQUAL(5, ring.pop(Span<KX134Frame>(block, 5)));
+        for (int i = 0; i < 5; ++i)
+        {
+            CHECK_EQUAL(popped, block[i].timestamp);
+            CHECK_EQUAL(static_cast<int16_t>(-popped), block[i].y);
+            ++popped;
+        }
+    }
+
+    CHECK_EQUAL(0, ring.size());
+    CHECK_EQUAL(0, ring.dropCount());
+}
+
+static void testShortRead()
+{
+    KX134StaticSampleRing<16> ring;
+    for (uint32_t i = 0; i < 7; ++i)
+    {
+        ring.push(frame(i));
+    }
+
+    // a Span smaller than the ring's contents only takes what fits
+    KX134Frame block[3];
+    CHECK_EQUAL(3, ring.pop(Span<KX134Frame>(block, 3)));
+    CHECK_EQUAL(0, block[0].timestamp);
+    CHECK_EQUAL(2, block[2].timestamp);
+    CHECK_EQUAL(4, ring.size());
+
+    CHECK_EQUAL(3, ring.pop(Span<KX134Frame>(block, 3)));
+    CHECK_EQUAL(3, block[0].timestamp);
+
+    // and a larger read returns only what is available
+    CHECK_EQUAL(1, ring.pop(Span<KX134Frame>(block, 3)));
+    CHECK_EQUAL(6, block[0].timestamp);
+}
+
+static void testConcurrent()
+{
+    static KX134StaticSampleRing<64> ring;
+    const uint32_t count = 20000;
+
+    std::thread producer([]() {
+        uint32_t i = 0;
+        while (i < count)
+        {
+            // only push when there is room, so nothing is dropped
+            if (ring.size() < ring.capacity() && ring.push(frame(i)))
+            {
+                ++i;
+            }
+            else
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    // frames arrive complete and in order
+    uint32_t expected = 0;
+    bool ordered = true;
+    while (expected < count)
+    {
+        KX134Frame block[5];
+        size_t n = ring.pop(Span<KX134Frame>(block, 5));
+        if (n == 0)
+        {
+            std::this_thread::yield();
+        }
+        for (size_t i = 0; i < n; ++i)
+        {
+            ordered &= block[i].timestamp == expected
+                && block[i].z == static_cast<int16_t>(expected * 2);
+            ++expected;
+        }
+    }
+    producer.join();
+
+    CHECK(ordered);
+    CHECK_EQUAL(0, ring.dropCount());
+}
+
+int main()
+{
+    testEmpty();
+    testFull();
+    testWrapAround();
+    testShortRead();
+    testConcurrent();
+    return kx134TestResult();
+}
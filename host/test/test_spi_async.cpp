@@ -0,0 +1,39 @@
+//
+// KX134SPI's asynchronous buffer read when the SPI peripheral rejects the transfer. The host SPI
+// shim rejects every asynchronous transfer.
+//
+
+#include "KX134SPI.h"
+#include "KX134Test.h"
+
+static bool completed = false;
+
+static void onComplete(const int16_t* samples, size_t count)
+{
+    (void)samples;
+    (void)count;
+    completed = true;
+}
+
+static void testRejectedTransfer()
+{
+    KX134SPIBus bus(PB_5, PB_4, PB_3);
+    KX134SPI accel(bus, PA_4);
+
+    CHECK(!accel.readBufferAsync(10, callback(onComplete)));
+    CHECK(!accel.asyncBusy());
+    CHECK(!completed);
+
+    // the bus is released: blocking transactions and a new transfer attempt go through
+    KX134Base::BusStats before = accel.getBusStats();
+    CHECK(!accel.checkExistence());
+    CHECK_EQUAL(before.transactions + 1, accel.getBusStats().transactions);
+    CHECK(!accel.readBufferAsync(10, callback(onComplete)));
+    CHECK(!accel.asyncBusy());
+}
+
+int main()
+{
+    testRejectedTransfer();
+    return kx134TestResult();
+}
@@ -0,0 +1,74 @@
+//
+// KX134<Transport> reads the sample buffer exactly as KX134Base does through the virtual path
+//
+
+#include "KX134.h"
+#include "KX134Frame.h"
+#include "KX134Sim.h"
+#include "KX134Test.h"
+
+/**
+ * @brief Signal changing every sample, so that samples read out of order would not match
+ */
+static void rampSignal(uint64_t timeNs, uint8_t rangeG, int16_t* output)
+{
+    (void)rangeG;
+
+    const uint32_t timeUs = timeNs / 1000;
+    output[0] = timeUs % 30000;
+    output[1] = -(timeUs % 20000);
+    output[2] = timeUs % 1000;
+}
+
+static void setUp(KX134Sim& sim, KX134Base::BufferResolution resolution)
+{
+    CHECK(sim.init());
+    sim.setSignalSource(callback(rampSignal));
+    sim.applyConfig(KX134Base::Config()
+                        .outputDataRate(KX134Base::OutputDataRate::ODR_1600HZ)
+                        .buffer(KX134Base::BufferMode::STREAM, 20, resolution));
+    sim.clearBuffer();
+}
+
+static void testSameSamples(KX134Base::BufferResolution resolution)
+{
+    KX134<KX134Sim> bound;
+    KX134Sim plain;
+    setUp(bound, resolution);
+    setUp(plain, resolution);
+
+    static int16_t boundSamples[KX134Base::BUFFER_MAX_SAMPLES * 3];
+    static int16_t plainSamples[KX134Base::BUFFER_MAX_SAMPLES * 3];
+
+    // partial reads leave samples behind, then full reads catch up
+    const size_t maxSamples[] = { 10, 10, KX134Base::BUFFER_MAX_SAMPLES, 5,
+        KX134Base::BUFFER_MAX_SAMPLES };
+    for (size_t maxCount : maxSamples)
+    {
+        bound.advance(std::chrono::microseconds(20000));
+        plain.advance(std::chrono::microseconds(20000));
+
+        size_t boundCount = bound.readBuffer(boundSamples, maxCount);
+        size_t plainCount = plain.readBuffer(plainSamples, maxCount);
+        CHECK_EQUAL(plainCount, boundCount);
+        CHECK(memcmp(boundSamples, plainSamples, 3 * sizeof(int16_t) * plainCount) == 0);
+    }
+
+    // the frames read afterwards are timed alike
+    static KX134Frame boundFrames[KX134Base::BUFFER_MAX_SAMPLES];
+    static KX134Frame plainFrames[KX134Base::BUFFER_MAX_SAMPLES];
+    bound.advance(std::chrono::microseconds(20000));
+    plain.advance(std::chrono::microseconds(20000));
+
+    size_t boundCount = bound.readFrames(boundFrames, KX134Base::BUFFER_MAX_SAMPLES);
+    size_t plainCount = plain.readFrames(plainFrames, KX134Base::BUFFER_MAX_SAMPLES);
+    CHECK_EQUAL(plainCount, boundCount);
+    CHECK(memcmp(boundFrames, plainFrames, sizeof(KX134Frame) * plainCount) == 0);
+}
+
+int main()
+{
+    testSameSamples(KX134Base::BufferResolution::RES_16BIT);
+    testSameSamples(KX134Base::BufferResolution::RES_8BIT);
+    return kx134TestResult();
+}
@@ -0,0 +1,97 @@
+//
+// Trigger mode capture: the trigger index, whether or not the pre-trigger samples had filled
+//
+
+#include "KX134Sim.h"
+#include "KX134Test.h"
+#include "KX134TriggerCapture.h"
+
+#define PERIOD_US 625 // 1600Hz
+#define PRE_TRIGGER 32
+
+static size_t captures = 0;
+static size_t lastCount = 0;
+static size_t lastTriggerIndex = 0;
+
+static void onCapture(const KX134Frame* frames, size_t count, size_t triggerIndex)
+{
+    (void)frames;
+    ++captures;
+    lastCount = count;
+    lastTriggerIndex = triggerIndex;
+}
+
+static void setUp(KX134Sim& sim)
+{
+    CHECK(sim.init());
+    sim.setBusTiming(10, 100);
+    sim.applyConfig(
+        KX134Base::Config().outputDataRate(KX134Base::OutputDataRate::ODR_1600HZ));
+    captures = 0;
+}
+
+/**
+ * @brief Triggers the buffer, interrupting the MCU some samples later, and fills the buffer
+ */
+static void triggerLate(KX134Sim& sim, EventQueue& queue, uint32_t delaySamples)
+{
+    sim.trigger();
+    sim.advance(std::chrono::microseconds(delaySamples * PERIOD_US));
+    sim.handleInterrupt(KX134Base::InterruptPin::INT1);
+
+    // buffer full interrupts once the post-trigger samples are in
+    sim.advance(std::chrono::microseconds(KX134Base::BUFFER_MAX_SAMPLES * PERIOD_US));
+    queue.dispatch_once();
+}
+
+static void testFilledBeforeTrigger()
+{
+    KX134Sim sim;
+    EventQueue queue;
+    setUp(sim);
+
+    KX134TriggerCapture capture(sim, queue);
+    capture.arm(KX134Base::InterruptPin::INT1, NC, KX134Base::INT_TAP, PRE_TRIGGER,
+        callback(onCapture));
+
+    // the buffer holds PRE_TRIGGER samples long before the trigger. Interrupt latency and
+    // detection delay do not move the trigger index.
+    for (uint32_t delay : { 0, 1, 3 })
+    {
+        sim.advance(std::chrono::microseconds(100 * PERIOD_US));
+        triggerLate(sim, queue, delay);
+
+        CHECK_EQUAL(sim.getBufferCapacity(), lastCount);
+        CHECK_EQUAL(PRE_TRIGGER, lastTriggerIndex);
+    }
+    CHECK_EQUAL(3, captures);
+
+    capture.disarm();
+}
+
+static void testTriggerSoonAfterArming()
+{
+    KX134Sim sim;
+    EventQueue queue;
+    setUp(sim);
+
+    KX134TriggerCapture capture(sim, queue);
+    capture.arm(KX134Base::InterruptPin::INT1, NC, KX134Base::INT_TAP, PRE_TRIGGER,
+        callback(onCapture));
+
+    // only 10 samples were buffered before the trigger, as the interrupt times tell
+    sim.advance(std::chrono::microseconds(10 * PERIOD_US));
+    triggerLate(sim, queue, 0);
+
+    CHECK_EQUAL(1, captures);
+    CHECK(lastTriggerIndex >= 9 && lastTriggerIndex <= 11);
+
+    capture.disarm();
+}
+
+int main()
+{
+    testFilledBeforeTrigger();
+    testTriggerSoonAfterArming();
+    return kx134TestResult();
+}
@@ -2,14 +2,17 @@
 // Created by Jasper Swallen on 2-15-21
 //
 
-#include <algorithm>
 #include <cinttypes>
 #include <cmath>
-#include <limits>
 
 #include "KX134TestSuite.h"
 #include "KX134Base.h"
+#include "KX134CaptureWriter.h"
+#include "KX134Frame.h"
+#include "KX134Stats.h"
+#include "HeapBlockDevice.h"
 #include "mbed.h"
+#include "mbed_trace.h"
 
 void KX134TestSuite::test_existence()
 {
@@ -33,7 +36,8 @@ void KX134TestSuite::set_hz()
     getc(stdin);
     printf("\r\nSetting ODR to %d hz\r\n", hz);
 
-    new_accel.setOutputDataRateHz(hz);
+    float actualHz = new_accel.setOutputDataRateHz(hz);
+    printf("Selected ODR: %f hz\r\n", actualHz);
 }
 
 // This test pairs well with the standard deviation test
@@ -76,70 +80,234 @@ void KX134TestSuite::set_range()
 void KX134TestSuite::test_stddev()
 {
     const int numTrials = 200;
-    float gravs[numTrials][3];
+    KX134Stats stats(numTrials, KX134Stats::Window::TUMBLING, new_accel.getGravsPerLsb());
 
-    for (size_t trialIndex = 0; trialIndex < numTrials; ++trialIndex)
+    while (stats.windowCount() == 0)
     {
-        while (!new_accel.dataReady())
-            ;
+        if (new_accel.interruptEnabled(KX134Base::InterruptPin::INT1))
+        {
+            new_accel.waitForInterrupt(KX134Base::INT1_FLAG);
+        }
+        else
+        {
+            while (!new_accel.dataReady())
+                ;
+        }
 
         int16_t output[3];
         new_accel.getAccelerations(output);
-        float ax = new_accel.convertRawToGravs(output[0]);
-        float ay = new_accel.convertRawToGravs(output[1]);
-        float az = new_accel.convertRawToGravs(output[2]);
+        stats.add(output);
+    }
+
+    KX134Stats::AxisStats axes[3];
+    stats.getStats(axes);
+
+    printf("Average Gravs: %f x, %f y, %f z\n", axes[0].mean, axes[1].mean, axes[2].mean);
+    printf("Standard Deviation: %f x, %f y, %f z\n",
+        axes[0].stdDev,
+        axes[1].stdDev,
+        axes[2].stdDev);
+    printf("Min Gravs: %f x, %f y, %f z\n", axes[0].min, axes[1].min, axes[2].min);
+    printf("Max Gravs: %f x, %f y, %f z\n", axes[0].max, axes[1].max, axes[2].max);
+    printf("RMS Gravs: %f x, %f y, %f z\n", axes[0].rms, axes[1].rms, axes[2].rms);
+    printf("Crest Factor: %f x, %f y, %f z\n",
+        axes[0].crestFactor,
+        axes[1].crestFactor,
+        axes[2].crestFactor);
+}
 
-        printf("KX134 Accel: X: %" PRIi16 " LSB, Y: %" PRIi16 " LSB, Z: %" PRIi16 " LSB \r\n",
-            output[0],
-            output[1],
-            output[2]);
-        printf("KX134 Accel in Gravs: X: %f g, Y: %f g, Z: %f g \r\n", ax, ay, az);
+void KX134TestSuite::test_transaction_rate()
+{
+    const int numTrials = 1000;
+    Timer timer;
+
+#if KX134_INSTRUMENTATION
+    new_accel.resetBusProfile();
+#endif
 
-        gravs[trialIndex][0] = ax;
-        gravs[trialIndex][1] = ay;
-        gravs[trialIndex][2] = az;
+    // checkExistence() performs two single-byte register reads
+    timer.start();
+    for (int trialIndex = 0; trialIndex < numTrials; ++trialIndex)
+    {
+        new_accel.checkExistence();
+    }
+    timer.stop();
+
+    float seconds = std::chrono::duration<float>(timer.elapsed_time()).count();
+    printf("Single-byte reads: %.0f transactions/s\r\n", 2 * numTrials / seconds);
+
+    int16_t output[3];
+    timer.reset();
+    timer.start();
+    for (int trialIndex = 0; trialIndex < numTrials; ++trialIndex)
+    {
+        new_accel.getAccelerations(output);
     }
+    timer.stop();
 
-    float average[3] = { 0 };
-    float maxGravs[3] = { 0 };
-    float minGravs[3] = { std::numeric_limits<float>::max() };
+    seconds = std::chrono::duration<float>(timer.elapsed_time()).count();
+    printf("6-byte acceleration reads: %.0f transactions/s\r\n", numTrials / seconds);
 
-    for (size_t trialIndex = 0; trialIndex < numTrials; ++trialIndex)
+#if KX134_INSTRUMENTATION
+    KX134Base::BusProfile profile = new_accel.getBusProfile();
+    printf("Bus profile: %" PRIu32 " transactions, %" PRIu32 " bytes, %" PRIu32 " us on the bus, "
+           "%" PRIu32 " errors\r\n",
+        profile.totals.transactions,
+        profile.totals.bytes,
+        profile.busTimeUs,
+        profile.errors);
+
+    for (size_t addr = 0; addr < KX134Base::REGISTER_COUNT; ++addr)
     {
-        for (int i = 0; i < 3; ++i)
+        if (profile.reads[addr] != 0 || profile.writes[addr] != 0)
         {
-            average[i] += gravs[trialIndex][i];
-            maxGravs[i] = std::max(gravs[trialIndex][i], maxGravs[i]);
-            minGravs[i] = std::min(gravs[trialIndex][i], minGravs[i]);
+            printf("Register 0x%02X: %" PRIu32 " reads, %" PRIu32 " writes\r\n",
+                static_cast<unsigned>(addr),
+                profile.reads[addr],
+                profile.writes[addr]);
         }
     }
+#endif
+}
+
+void KX134TestSuite::test_capture()
+{
+    const size_t numSamples = 1000;
+    const size_t numBlocks = 32;
+    HeapBlockDevice device(
+        numBlocks * KX134CaptureWriter::BLOCK_SIZE, 1, 1, KX134CaptureWriter::BLOCK_SIZE);
+    device.init();
 
-    for (int i = 0; i < 3; ++i)
+    uint8_t odr = new_accel.getOutputDataRateBytes();
+    KX134CaptureFormat::Header header = {};
+    header.rangeG = 8 << static_cast<uint8_t>(new_accel.getAccelRange());
+    header.outputDataRate = odr;
+    header.gravsPerLsb = new_accel.getGravsPerLsb();
+
+    KX134CaptureWriter writer(device);
+    if (writer.begin(header) != BD_ERROR_OK)
     {
-        average[i] /= numTrials;
+        printf("[FAILURE] Could not write the capture header\r\n");
+        return;
     }
 
-    float variance[3] = { 0 };
-    for (size_t trialIndex = 0; trialIndex < numTrials; ++trialIndex)
+    printf("Capturing %u samples at %f hz\r\n",
+        static_cast<unsigned>(numSamples),
+        KX134Base::outputDataRateToHz(static_cast<KX134Base::OutputDataRate>(odr)));
+
+    new_accel.enableBuffer(KX134Base::BufferMode::STREAM, KX134Base::BUFFER_MAX_SAMPLES / 2);
+    new_accel.clearBuffer();
+
+    // static, as the frames and the block below would take most of the main thread's stack
+    static KX134Frame frames[KX134Base::BUFFER_MAX_SAMPLES];
+    size_t captured = 0;
+    while (captured < numSamples)
     {
-        for (int i = 0; i < 3; ++i)
+        size_t count = new_accel.readFrames(frames, KX134Base::BUFFER_MAX_SAMPLES);
+        float periodUs = 1000000.0f / new_accel.getSampleClock().getRateHz();
+        if (writer.write(frames, count, periodUs) != BD_ERROR_OK)
         {
-            variance[i] += std::pow(gravs[trialIndex][i] - average[i], 2);
+            break;
         }
+        captured += count;
     }
 
-    float stdDeviation[3];
-    for (int i = 0; i < 3; ++i)
+    new_accel.disableBuffer();
+    writer.flush();
+
+    // decode the capture back
+    static uint8_t block[KX134CaptureWriter::BLOCK_SIZE];
+    size_t decoded = 0;
+    for (uint32_t sequence = 0; sequence + 1 < numBlocks; ++sequence)
     {
-        variance[i] /= numTrials - 1;
-        stdDeviation[i] = std::sqrt(variance[i]);
+        device.read(block, (sequence + 1) * KX134CaptureWriter::BLOCK_SIZE, sizeof(block));
+
+        int count = KX134CaptureFormat::decodeBlock(block, sizeof(block), sequence, frames, 0);
+        if (count < 0)
+        {
+            break;
+        }
+        decoded += count;
     }
 
-    printf("Average Gravs: %f x, %f y, %f z\n", average[0], average[1], average[2]);
-    printf("Standard Deviation: %f x, %f y, %f z\n",
-        stdDeviation[0],
-        stdDeviation[1],
-        stdDeviation[2]);
+    printf("Wrote %u samples in %u bytes (%u bytes raw)\r\n",
+        static_cast<unsigned>(writer.samplesWritten()),
+        static_cast<unsigned>(writer.bytesWritten()),
+        static_cast<unsigned>(writer.samplesWritten() * KX134Base::BUFFER_BYTES_PER_SAMPLE));
+
+    if (decoded == writer.samplesWritten())
+    {
+        printf("[SUCCESS]\r\n");
+    }
+    else
+    {
+        printf("[FAILURE] Decoded %u samples\r\n", static_cast<unsigned>(decoded));
+    }
+
+    device.deinit();
+}
+
+void KX134TestSuite::test_adp()
+{
+    const int numTrials = 256;
+    const float toleranceGravs = 0.01f;
+    float gravsPerLsb = new_accel.getGravsPerLsb();
+
+    // filters bypassed, so the ADP outputs the RMS of the accelerations
+    KX134Base::OutputDataRate odr
+        = static_cast<KX134Base::OutputDataRate>(new_accel.getOutputDataRateBytes());
+    new_accel.applyConfig(KX134Base::Config()
+                              .advancedDataPath(odr,
+                                  KX134Base::AdpRmsAverage::RMS_16,
+                                  KX134Base::AdpOutput::RMS)
+                              .noAdpFilter1()
+                              .noAdpFilter2());
+
+    KX134Stats softwareStats(numTrials, KX134Stats::Window::TUMBLING, gravsPerLsb);
+    KX134Stats adpStats(numTrials, KX134Stats::Window::TUMBLING, gravsPerLsb);
+
+    while (softwareStats.windowCount() == 0)
+    {
+        if (new_accel.interruptEnabled(KX134Base::InterruptPin::INT1))
+        {
+            new_accel.waitForInterrupt(KX134Base::INT1_FLAG);
+        }
+        else
+        {
+            while (!new_accel.dataReady())
+                ;
+        }
+
+        int16_t adp[3];
+        int16_t output[3];
+        new_accel.getAdpOutputs(adp, output);
+        softwareStats.add(output);
+        adpStats.add(adp);
+    }
+
+    new_accel.applyConfig(KX134Base::Config().noAdvancedDataPath());
+
+    KX134Stats::AxisStats software[3];
+    KX134Stats::AxisStats adp[3];
+    softwareStats.getStats(software);
+    adpStats.getStats(adp);
+
+    printf("Software RMS Gravs: %f x, %f y, %f z\r\n",
+        software[0].rms,
+        software[1].rms,
+        software[2].rms);
+    printf("ADP RMS Gravs: %f x, %f y, %f z\r\n", adp[0].mean, adp[1].mean, adp[2].mean);
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        if (std::fabs(software[axis].rms - adp[axis].mean) > toleranceGravs)
+        {
+            printf("[FAILURE] Axis %d differs by more than %f g\r\n", axis, toleranceGravs);
+            return;
+        }
+    }
+
+    printf("[SUCCESS]\r\n");
 }
 
 #if HAMSTER_SIMULATOR != 1
@@ -148,16 +316,25 @@ int main()
 int kx134_test_main()
 #endif
 {
+    mbed_trace_init();
+
     if (!new_accel.init())
     {
         printf("Failed to initialize KX134\r\n");
         ThisThread::sleep_for(1s);
         return 1;
     }
-    printf("Successfully initialized KX134\r\n");
+    printf("Successfully initialized KX134 in %lld us\r\n",
+        static_cast<long long>(new_accel.getTimeToReady().count()));
 
     new_accel.setAccelRange(KX134Base::Range::RANGE_64G);
 
+    if (PIN_KX134_INT1 != NC)
+    {
+        new_accel.enableInterrupt(
+            KX134Base::InterruptPin::INT1, PIN_KX134_INT1, KX134Base::INT_DATA_READY);
+    }
+
     // test suite harness
     KX134TestSuite harness;
 
@@ -172,6 +349,9 @@ int kx134_test_main()
         printf("2.  Set Output Data Rate\r\n");
         printf("3.  Set Range\r\n");
         printf("4.  Read Data & Standard Deviation\r\n");
+        printf("5.  Measure Bus Transaction Rate\r\n");
+        printf("6.  Capture to Binary Format\r\n");
+        printf("7.  Compare ADP RMS to Software RMS\r\n");
 
         scanf("%d", &test);
         getc(stdin);
@@ -193,6 +373,15 @@ int kx134_test_main()
             case 4:
                 harness.test_stddev();
                 break;
+            case 5:
+                harness.test_transaction_rate();
+                break;
+            case 6:
+                harness.test_capture();
+                break;
+            case 7:
+                harness.test_adp();
+                break;
             default:
                 printf("Invalid test number\r\n");
                 break;